@@ -0,0 +1,30 @@
+# Script mode part of vir_discover_tests (VirTest.cmake): writes the add_test calls for
+# all tests listed by `${EXECUTABLE} --list` to ${CTEST_FILE}. The tests run in parallel,
+# therefore they must not share the state file of --rerun-failed.
+execute_process(
+   COMMAND ${EXECUTABLE} --list --state-file=
+   RESULT_VARIABLE result
+   OUTPUT_VARIABLE output
+   WORKING_DIRECTORY ${WORKING_DIRECTORY})
+if(NOT result EQUAL 0)
+   message(FATAL_ERROR "${EXECUTABLE} --list failed (${result}):\n${output}")
+endif()
+
+set(extra)
+foreach(arg ${EXTRA_ARGS})
+   string(APPEND extra " [==[${arg}]==]")
+endforeach()
+
+set(content "")
+string(REGEX REPLACE "\n$" "" output "${output}")
+string(REPLACE ";" "\;" output "${output}")
+string(REPLACE "\n" ";" names "${output}")
+foreach(name ${names})
+   string(REPLACE " " "" test_name "${PREFIX}${name}")
+   string(APPEND content
+      "add_test([==[${test_name}]==] [==[${EXECUTABLE}]==] --only [==[${name}]==]"
+      " --state-file=${extra})\n"
+      "set_tests_properties([==[${test_name}]==] PROPERTIES"
+      " WORKING_DIRECTORY [==[${WORKING_DIRECTORY}]==] SKIP_REGULAR_EXPRESSION \" SKIP: \")\n")
+endforeach()
+file(WRITE ${CTEST_FILE} "${content}")
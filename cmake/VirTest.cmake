@@ -0,0 +1,103 @@
+# vir_discover_tests(<target> [PREFIX <prefix>] [EXTRA_ARGS <args>...])
+#
+# Registers one CTest test per TEST/TEST_TYPES instantiation of the virtest executable
+# <target>, similar to gtest_discover_tests. After every build of <target> its test names
+# are queried with `--list`; each test runs as `<target> --only <name> <args>` and is
+# named `<prefix><name>` (without the padding spaces of type names). <prefix> defaults to
+# `<target>.`. Requires CMake 3.10.
+set(_vir_discover_tests_script ${CMAKE_CURRENT_LIST_DIR}/VirDiscoverTests.cmake)
+
+function(vir_discover_tests target)
+   cmake_parse_arguments(arg "" "PREFIX" "EXTRA_ARGS" ${ARGN})
+   if(NOT DEFINED arg_PREFIX)
+      set(arg_PREFIX "${target}.")
+   endif()
+   set(ctest_file "${CMAKE_CURRENT_BINARY_DIR}/${target}_tests.cmake")
+   add_custom_command(TARGET ${target} POST_BUILD
+      COMMAND ${CMAKE_COMMAND}
+         -D "EXECUTABLE=$<TARGET_FILE:${target}>"
+         -D "PREFIX=${arg_PREFIX}"
+         -D "EXTRA_ARGS=${arg_EXTRA_ARGS}"
+         -D "WORKING_DIRECTORY=${CMAKE_CURRENT_BINARY_DIR}"
+         -D "CTEST_FILE=${ctest_file}"
+         -P ${_vir_discover_tests_script}
+      COMMENT "Discovering tests of ${target}"
+      VERBATIM)
+   # the tests are only known after the first build
+   set(include_file "${CMAKE_CURRENT_BINARY_DIR}/${target}_include.cmake")
+   file(WRITE ${include_file}
+      "if(EXISTS \"${ctest_file}\")\n"
+      "  include(\"${ctest_file}\")\n"
+      "else()\n"
+      "  add_test(${target}_NOT_BUILT ${target}_NOT_BUILT)\n"
+      "endif()\n")
+   set_property(DIRECTORY APPEND PROPERTY TEST_INCLUDE_FILES ${include_file})
+endfunction()
+
+# vir_add_isa_tests(<name> SOURCES <source>... [LEVELS <level>...] [ARGS <args>...])
+#
+# Builds the test executable <name>-<level> from <source>... with -march=<level> for every
+# x86-64 micro-architecture level (default: x86-64 x86-64-v2 x86-64-v3 x86-64-v4) the
+# compiler knows, and adds one CTest test per level. The tests run through the virtest-isa
+# launcher, which skips levels the CPU does not support. Other architectures and compilers
+# without -march get only the default build, named <name>. The created targets are
+# returned in <name>_TARGETS. Requires CMake 3.10.
+include(CheckCXXCompilerFlag)
+
+function(vir_add_isa_tests name)
+   cmake_parse_arguments(arg "" "" "SOURCES;LEVELS;ARGS" ${ARGN})
+   if(NOT arg_LEVELS)
+      set(arg_LEVELS x86-64 x86-64-v2 x86-64-v3 x86-64-v4)
+   endif()
+   if(TARGET virtest-isa)
+      set(launcher $<TARGET_FILE:virtest-isa>)
+   else()
+      find_program(VIRTEST_ISA_LAUNCHER virtest-isa)
+      set(launcher ${VIRTEST_ISA_LAUNCHER})
+   endif()
+   set(levels)
+   if(CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64" AND launcher)
+      foreach(level ${arg_LEVELS})
+         string(MAKE_C_IDENTIFIER "vir_march_${level}" flag_var)
+         check_cxx_compiler_flag("-march=${level}" ${flag_var})
+         if(${flag_var})
+            list(APPEND levels ${level})
+         endif()
+      endforeach()
+   endif()
+   if(NOT levels)
+      add_executable(${name} ${arg_SOURCES})
+      add_test(NAME ${name} COMMAND ${name} ${arg_ARGS})
+      set(${name}_TARGETS ${name} PARENT_SCOPE)
+      return()
+   endif()
+   set(targets)
+   foreach(level ${levels})
+      list(APPEND targets ${name}-${level})
+      add_executable(${name}-${level} ${arg_SOURCES})
+      target_compile_options(${name}-${level} PRIVATE -march=${level})
+      add_test(NAME ${name}-${level}
+         COMMAND ${launcher} ${level} $<TARGET_FILE:${name}-${level}> ${arg_ARGS})
+      set_tests_properties(${name}-${level} PROPERTIES SKIP_RETURN_CODE 77)
+   endforeach()
+   set(${name}_TARGETS ${targets} PARENT_SCOPE)
+endfunction()
+
+# VIR_COMPILE_TIME_SEED (cache variable)
+#
+# The seed of VIR_CHOOSE_ONE_RANDOMLY and VIR_CHOOSE_K_RANDOMLY for all targets in the
+# including directory and below: an unsigned integer (e.g. a CI build number), or DATE for
+# the UTC date at configure time (YYYYMMDD, i.e. a new choice per day). If empty, the
+# choices change with every compilation, which defeats ccache.
+set(VIR_COMPILE_TIME_SEED "" CACHE STRING
+   "Seed of VIR_CHOOSE_ONE_RANDOMLY/VIR_CHOOSE_K_RANDOMLY: an unsigned integer, DATE, or empty")
+if(VIR_COMPILE_TIME_SEED AND NOT _vir_compile_time_seed)
+   if(VIR_COMPILE_TIME_SEED STREQUAL "DATE")
+      string(TIMESTAMP _vir_compile_time_seed "%Y%m%d" UTC)
+   elseif(VIR_COMPILE_TIME_SEED MATCHES "^[0-9]+$")
+      set(_vir_compile_time_seed ${VIR_COMPILE_TIME_SEED})
+   else()
+      message(FATAL_ERROR "VIR_COMPILE_TIME_SEED must be an unsigned integer or DATE")
+   endif()
+   add_definitions(-DVIR_COMPILE_TIME_SEED=${_vir_compile_time_seed})
+endif()
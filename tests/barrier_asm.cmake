@@ -0,0 +1,49 @@
+# Expects CXX (the compiler), SOURCE (barrier_asm.cpp), INCLUDE (the source dir), and
+# FLAGS (a list of flag sets, separated by '|').
+string(REPLACE "|" ";" flag_sets "${FLAGS}")
+
+function(count_instructions asm name result)
+   string(REGEX MATCH "\n${name}:\n.*" body "${asm}")
+   if(NOT body)
+      message(FATAL_ERROR "function ${name} not found in assembly")
+   endif()
+   string(REGEX REPLACE "\n[ \t]*\\.(cfi_endproc|size)[^\n]*.*" "" body "${body}")
+   string(REGEX MATCHALL "\n[ \t]+[a-z][^\n]*" instructions "${body}")
+   list(LENGTH instructions n)
+   set(${result} ${n} PARENT_SCOPE)
+   set(${result}_body "${body}" PARENT_SCOPE)
+endfunction()
+
+foreach(flags ${flag_sets})
+   separate_arguments(flag_list UNIX_COMMAND "${flags}")
+   execute_process(
+      COMMAND ${CXX} -std=c++11 -O2 ${flag_list} -I${INCLUDE} -S ${SOURCE} -o barrier_asm.s
+      RESULT_VARIABLE ok
+      ERROR_VARIABLE error)
+   if(NOT ok EQUAL 0)
+      message(FATAL_ERROR "compiling ${SOURCE} with ${flags} failed:\n${error}")
+   endif()
+   file(READ barrier_asm.s asm)
+
+   string(REGEX MATCHALL "\nref_[a-z0-9]+:" refs "${asm}")
+   foreach(ref ${refs})
+      string(REGEX REPLACE "\nref_([a-z0-9]+):" "\\1" name "${ref}")
+      count_instructions("${asm}" ref_${name} n_ref)
+      foreach(variant barrier barrier_unknown)
+         count_instructions("${asm}" ${variant}_${name} n)
+         if(NOT n EQUAL n_ref)
+            message(FATAL_ERROR "${variant}_${name} (${flags}) needs ${n} instead of ${n_ref} instructions:${n_body}\n\ninstead of:${n_ref_body}")
+         endif()
+      endforeach()
+      message(" PASS: do_not_optimize(${name}) ${flags}")
+   endforeach()
+
+   foreach(name int memory range)
+      count_instructions("${asm}" folded_${name} n_folded)
+      count_instructions("${asm}" opaque_${name} n_opaque)
+      if(NOT n_opaque GREATER n_folded)
+         message(FATAL_ERROR "opaque_${name} (${flags}) was optimized like folded_${name}:${n_opaque_body}")
+      endif()
+      message(" PASS: opaque ${name} ${flags}")
+   endforeach()
+endforeach()
@@ -0,0 +1,97 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+// This file is not executed. barrier_asm.cmake compiles it to assembly and compares the
+// number of instructions of the ref_* and barrier_* functions, which must be equal, and of
+// the folded_* and opaque_* functions, where the latter must be larger.
+
+#include <vir/test.h>
+
+typedef float float4 [[gnu::vector_size(16)]];
+struct wrapped4 {  // a trivially copyable SIMD wrapper class
+  float4 data;
+};
+
+#define VIR_BARRIER_FUNCTIONS(T, name, ...)                                              \
+  extern "C" T ref_##name(T x) { return __VA_ARGS__; }                                  \
+  extern "C" T barrier_##name(T x)                                                       \
+  {                                                                                      \
+    vir::test::do_not_optimize(x);                                                       \
+    return __VA_ARGS__;                                                                  \
+  }                                                                                      \
+  extern "C" T barrier_unknown_##name(T x)                                               \
+  {                                                                                      \
+    x = vir::test::make_value_unknown(x);                                                \
+    return __VA_ARGS__;                                                                  \
+  }
+
+VIR_BARRIER_FUNCTIONS(int, int, x + 1)
+VIR_BARRIER_FUNCTIONS(const int *, pointer, x + 1)
+VIR_BARRIER_FUNCTIONS(float, float, x * 2)
+VIR_BARRIER_FUNCTIONS(double, double, x * x)
+VIR_BARRIER_FUNCTIONS(float4, float4, x + x)
+VIR_BARRIER_FUNCTIONS(wrapped4, wrapped4, wrapped4{x.data + x.data})
+#ifdef __AVX__
+typedef double double4 [[gnu::vector_size(32)]];
+VIR_BARRIER_FUNCTIONS(double4, double4, x * x)
+#endif
+#ifdef __AVX512F__
+typedef int int16 [[gnu::vector_size(64)]];
+VIR_BARRIER_FUNCTIONS(int16, int16, x + x)
+#endif
+
+extern "C" int folded_int() { return 2; }
+extern "C" int opaque_int()
+{
+  int x = 1;
+  vir::test::do_not_optimize(x);
+  return x + 1;
+}
+
+extern "C" int folded_memory(int *p)
+{
+  p[0] = 1;
+  return p[0] + 1;
+}
+extern "C" int opaque_memory(int *p)
+{
+  p[0] = 1;
+  vir::test::clobber_memory();
+  return p[0] + 1;
+}
+
+extern "C" int folded_range(int *p)
+{
+  p[1] = 1;
+  return p[1] + 1;
+}
+extern "C" int opaque_range(int *p)
+{
+  p[1] = 1;
+  vir::test::make_range_unknown(p, 2);
+  return p[1] + 1;
+}
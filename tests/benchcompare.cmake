@@ -0,0 +1,104 @@
+execute_process(
+   COMMAND ./benchmark -v --bench-baseline baseline.dat --bench-csv results.csv
+   RESULT_VARIABLE ok
+   OUTPUT_VARIABLE output)
+if(NOT ok EQUAL 0)
+   message(FATAL_ERROR "running benchmark failed")
+endif()
+
+# baseline.dat: one line per measurement with key, median, MAD, n, and the n samples
+set(num "[-+0-9.e]+")
+file(STRINGS baseline.dat lines)
+set(keys)
+foreach(line ${lines})
+   if(NOT line MATCHES "^([^\t]+)\t${num}\t${num}\t([0-9]+)(\t${num})+$")
+      message(FATAL_ERROR "malformed line in baseline.dat:\n${line}")
+   endif()
+   set(n ${CMAKE_MATCH_2})
+   string(REGEX REPLACE "#[0-9]+$" "" key "${CMAKE_MATCH_1}")
+   list(APPEND keys "${key}")
+   string(REGEX MATCHALL "\t" tabs "${line}")
+   list(LENGTH tabs ntabs)
+   math(EXPR ntabs "${ntabs} - 3")
+   if(NOT ntabs EQUAL n)
+      message(FATAL_ERROR "expected ${n} samples in baseline.dat:\n${line}")
+   endif()
+endforeach()
+list(LENGTH lines n)
+string(REGEX MATCHALL "\\(median ± MAD of " measurements "${output}")
+list(LENGTH measurements nmeasurements)
+if(n EQUAL 0 OR NOT n EQUAL nmeasurements)
+   message(FATAL_ERROR "expected ${nmeasurements} lines in baseline.dat, got:\n${lines}")
+endif()
+
+# results.csv: a header and one line per benchmark, type, and problem size
+file(STRINGS results.csv lines)
+list(GET lines 0 header)
+list(REMOVE_AT lines 0)
+if(NOT header STREQUAL "benchmark,type,size,median_s,mad_s,items_per_s,bytes_per_s,speedup")
+   message(FATAL_ERROR "unexpected results.csv header:\n${header}")
+endif()
+foreach(line ${lines})
+   if(NOT line MATCHES "^\"[^\"]+\",\"[^\"]*\",[0-9]+,${num},${num},(${num})?,(${num})?,(${num})?$")
+      message(FATAL_ERROR "malformed line in results.csv:\n${line}")
+   endif()
+endforeach()
+list(REMOVE_DUPLICATES keys)
+list(LENGTH keys nkeys)
+list(LENGTH lines n)
+if(NOT n EQUAL nkeys)
+   message(FATAL_ERROR "expected ${nkeys} benchmarks in results.csv, got:\n${lines}")
+endif()
+
+if(NOT output MATCHES " sum \\(speedup relative to int\\)\n   T \\\\ n +│ +16 │ +1024\n   int ")
+   message(FATAL_ERROR "types × sizes table missing:\n${output}")
+endif()
+
+# a baseline where accumulate took 1 fs per iteration must be reported as regression
+set(fast "accumulate\t1e-15\t0\t5\t1e-15\t1e-15\t1e-15\t1e-15\t1e-15\n")
+file(WRITE fast_baseline.dat "${fast}")
+execute_process(
+   COMMAND ./benchmark -v --bench-compare=fast_baseline.dat
+   RESULT_VARIABLE ok
+   OUTPUT_VARIABLE output)
+if(NOT ok EQUAL 1)
+   message(FATAL_ERROR "expected exactly one failure, got ${ok}:\n${output}")
+endif()
+if(NOT output MATCHES "accumulate is [0-9.e+]+% slower than the baseline")
+   message(FATAL_ERROR "regression not reported:\n${output}")
+endif()
+
+# an unreadable baseline fails the benchmarks instead of silently comparing to nothing
+execute_process(
+   COMMAND ./benchmark -v --bench-compare=no_such_baseline.dat
+   RESULT_VARIABLE ok
+   OUTPUT_VARIABLE output)
+if(ok EQUAL 0 OR NOT output MATCHES "cannot read benchmark baseline no_such_baseline.dat")
+   message(FATAL_ERROR "an unreadable baseline did not fail:\n${output}")
+endif()
+
+# as does an unwritable one
+execute_process(
+   COMMAND ./benchmark -v --bench-baseline=no_such_dir/baseline.dat
+   RESULT_VARIABLE ok
+   OUTPUT_VARIABLE output)
+if(ok EQUAL 0 OR NOT output MATCHES "cannot write benchmark baseline no_such_dir/baseline.dat")
+   message(FATAL_ERROR "an unwritable baseline did not fail:\n${output}")
+endif()
+
+# the same file for --bench-compare and --bench-baseline: compared before overwritten
+file(WRITE same_baseline.dat "${fast}")
+execute_process(
+   COMMAND ./benchmark -v --bench-compare=same_baseline.dat --bench-baseline=same_baseline.dat
+   RESULT_VARIABLE ok
+   OUTPUT_VARIABLE output)
+if(NOT ok EQUAL 1 OR NOT output MATCHES "accumulate is [0-9.e+]+% slower than the baseline")
+   message(FATAL_ERROR "the baseline was not read before it was overwritten:\n${output}")
+endif()
+file(STRINGS same_baseline.dat lines)
+list(LENGTH lines n)
+if(NOT n EQUAL nmeasurements)
+   message(FATAL_ERROR "expected ${nmeasurements} lines in same_baseline.dat, got:\n${lines}")
+endif()
+
+message(" PASS: benchmark baseline comparison works as expected")
@@ -0,0 +1,117 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#include <vir/test.h>
+#include <vir/benchmark.h>
+
+#include <numeric>
+
+TEST(sample_statistics)  //{{{1
+{
+  using vir::test::detail::median_of;
+  using vir::test::detail::summarize;
+  COMPARE(median_of({3., 1., 2.}), 2.);
+  COMPARE(median_of({4., 1., 3., 2.}), 2.5);
+
+  std::vector<double> samples = {10., 11., 9., 10., 10., 12., 8., 1000.};
+  const auto stats = summarize(samples);
+  COMPARE(stats.outliers, 1u);
+  COMPARE(samples.size(), 7u);
+  COMPARE(stats.median, 10.);
+  COMPARE(stats.mad, 1.);
+}
+
+TEST(mann_whitney)  //{{{1
+{
+  using vir::test::detail::mann_whitney_p;
+  const std::vector<double> fast = {1., 2., 3., 1.5, 2.5, 1., 2., 3., 1.5, 2.5};
+  const std::vector<double> slow = {4., 5., 6., 4.5, 5.5, 4., 5., 6., 4.5, 5.5};
+  VERIFY(mann_whitney_p(slow, fast) < 0.001) << mann_whitney_p(slow, fast);
+  VERIFY(mann_whitney_p(fast, slow) > 0.999) << mann_whitney_p(fast, slow);
+  const double same = mann_whitney_p(fast, fast);
+  VERIFY(same > 0.4 && same < 0.6) << same;
+}
+
+TEST(report_helpers)  //{{{1
+{
+  using vir::test::detail::split_benchmark_name;
+  using vir::test::detail::display_width;
+  using vir::test::detail::csv_quote;
+  COMPARE(split_benchmark_name("sum<float>").first, "sum");
+  COMPARE(split_benchmark_name("sum<simd<float, 4>>").second, "simd<float, 4>");
+  COMPARE(split_benchmark_name("sum<   int>").second, "int");
+  COMPARE(split_benchmark_name("accumulate").second, "");
+  COMPARE(display_width("1.5 µs (2.00×)"), 14u);
+  COMPARE(csv_quote("a, \"b\""), "\"a, \"\"b\"\"\"");
+}
+
+BENCHMARK(accumulate)  //{{{1
+{
+  std::vector<float> data(1024, 1.f);
+  vir::test::set_items_per_iteration(data.size());
+  vir::test::set_bytes_per_iteration(data.size() * sizeof(float));
+  const auto &r = vir::test::measure([&] {
+    return std::accumulate(data.begin(), data.end(), vir::test::make_value_unknown(0.f));
+  });
+  VERIFY(r.stats.median > 0);
+  COMPARE(r.items, 1024.);
+}
+
+BENCHMARK(results_stay_valid)  //{{{1
+{
+  const auto &first = vir::test::measure([] { return vir::test::make_value_unknown(1); });
+  const std::string key = first.key;
+  // later results must not move the first one (as a std::vector would on reallocation)
+  vir::test::measure([] { return vir::test::make_value_unknown(2); });
+  vir::test::measure([] { return vir::test::make_value_unknown(3); });
+  COMPARE(first.key, key);
+  COMPARE(first.name, "results_stay_valid");
+}
+
+BENCHMARK_TYPES(T, multiply, int, float, double)  //{{{1
+{
+  T x = 1;
+  vir::test::measure([&] { x *= vir::test::make_value_unknown(T(1)); });
+}
+
+BENCHMARK_TYPES(T, sum, int, float, double)  //{{{1
+{
+  for (std::size_t n : {16, 1024}) {
+    std::vector<T> data(n, T(1));
+    vir::test::set_problem_size(n);
+    vir::test::set_items_per_iteration(n);
+    const auto &r = vir::test::measure([&] {
+      vir::test::make_range_unknown(data.data(), data.size());
+      return std::accumulate(data.begin(), data.end(), T());
+    });
+    COMPARE(r.size, n);
+    COMPARE(r.key, "sum<" + vir::typeToString<T>() + ">/" + std::to_string(n));
+  }
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
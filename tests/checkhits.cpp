@@ -0,0 +1,58 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#define VIR_TEST_CHECK_HITS 1
+#include <vir/test.h>
+
+TEST(hot_loop)  //{{{1
+{
+  int sum = 0;
+  for (int i = 0; i < 1000; ++i) {
+    sum += i;
+    VERIFY(sum >= i);
+  }
+  COMPARE(sum, 499500);
+}
+
+TEST_TYPES(T, per_type, int, float)  //{{{1
+{
+  T x = 2;
+  COMPARE(x + x, T(4));
+}
+
+TEST(dead_branch)  //{{{1
+{
+  int x = 1;
+  x = vir::test::make_value_unknown(x);
+  if (x == 2) {
+    FUZZY_COMPARE(float(x), 2.f);
+    EXPECT_ULP_COMPARE(float(x), 2.f, 1);
+  }
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
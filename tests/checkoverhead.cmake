@@ -0,0 +1,27 @@
+# Expects CXX (the compiler), SOURCE (checkoverhead.cpp), and INCLUDE (the source dir).
+# Fails if the hot path of verify_loop or compare_loop stores to memory: a passing check
+# must compile to the comparison and the branch.
+execute_process(
+   COMMAND ${CXX} -std=c++11 -O2 -I${INCLUDE} -S ${SOURCE} -o checkoverhead.s
+   RESULT_VARIABLE ok
+   ERROR_VARIABLE error)
+if(NOT ok EQUAL 0)
+   message(FATAL_ERROR "compiling ${SOURCE} failed:\n${error}")
+endif()
+file(READ checkoverhead.s asm)
+foreach(function verify_loop compare_loop)
+   string(REGEX MATCH "\n${function}:\n.*" body "${asm}")
+   if(NOT body)
+      message(FATAL_ERROR "function ${function} not found in assembly")
+   endif()
+   # the cold failure path is a separate function (e.g. verify_loop.cold)
+   string(REGEX REPLACE "\n[ \t]*\\.(cfi_endproc|size)[^\n]*.*" "" body "${body}")
+   string(REGEX MATCHALL "\n[ \t]+[a-z][^\n]*" instructions "${body}")
+   foreach(instruction ${instructions})
+      # AT&T syntax: the destination is the last operand
+      if(instruction MATCHES "^\n[ \t]+(mov|add|sub|inc|dec|and|or|xor|set|st)[a-z]*[ \t][^\n]*(,[ \t]*|[ \t])[^, \t]*(\\(|%fs:)[^,]*$")
+         message(FATAL_ERROR "${function} stores to memory:${instruction}\n\nin:${body}")
+      endif()
+   endforeach()
+   message(" PASS: ${function} stores nothing")
+endforeach()
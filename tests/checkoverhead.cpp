@@ -0,0 +1,118 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#include <vir/test.h>
+
+// Measures the throughput of passing checks, i.e. the overhead the framework adds to
+// tests with many checks in tight loops. Run with --bench. checkoverhead.cmake inspects
+// the assembly of verify_loop and compare_loop.
+
+#include <vir/benchmark.h>
+
+#include <vector>
+
+namespace
+{
+constexpr std::size_t N = 1024;
+
+template <class T> std::vector<T> &data()
+{
+  static std::vector<T> v(N, T(1));
+  return v;
+}
+
+template <class F> void measure_checks(F &&check)
+{
+  vir::test::set_items_per_iteration(N);
+  vir::test::measure([&] {
+    auto &v = data<float>();
+    vir::test::make_range_unknown(v.data(), N);
+    for (std::size_t i = 0; i < N; ++i) {
+      check(v[i]);
+    }
+  });
+}
+}  // namespace
+
+// a passing check must not store anything (e.g. its location)
+extern "C" void verify_loop(const float *p, int n)
+{
+  for (int i = 0; i < n; ++i) {
+    VERIFY(p[i] > 0);
+  }
+}
+
+// nor may the failure path force the operands (here the loop counter) into memory
+extern "C" void compare_loop(const int *p, int n)
+{
+  for (int i = 0; i < n; ++i) {
+    COMPARE(p[i], i);
+  }
+}
+
+BENCHMARK(no_check)  //{{{1
+{
+  measure_checks([](float x) { vir::test::do_not_optimize(x); });
+}
+
+BENCHMARK(VERIFY)  //{{{1
+{
+  measure_checks([](float x) { VERIFY(x > 0); });
+}
+
+BENCHMARK(COMPARE)  //{{{1
+{
+  measure_checks([](float x) { COMPARE(x, 1.f); });
+}
+
+BENCHMARK(COMPARE_with_message)  //{{{1
+{
+  measure_checks([](float x) { COMPARE(x, 1.f) << "x = " << x; });
+}
+
+BENCHMARK(FUZZY_COMPARE)  //{{{1
+{
+  measure_checks([](float x) { FUZZY_COMPARE(x, 1.f); });
+}
+
+BENCHMARK(COMPARE_ABSOLUTE_ERROR)  //{{{1
+{
+  measure_checks([](float x) { COMPARE_ABSOLUTE_ERROR(x, 1.f, 1e-6f); });
+}
+
+BENCHMARK(COMPARE_RELATIVE_ERROR)  //{{{1
+{
+  measure_checks([](float x) { COMPARE_RELATIVE_ERROR(x, 1.f, 1e-6f); });
+}
+
+BENCHMARK(MEMCOMPARE)  //{{{1
+{
+  measure_checks([](float x) { MEMCOMPARE(x, 1.f); });
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
@@ -31,6 +31,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <cmath>
 #include <limits>
+#include <sstream>
+#include <vector>
 
 TEST(sanity_checks)  //{{{1
 {
@@ -62,6 +64,100 @@ TEST(xfail_fp)  //{{{1
   COMPARE(1.0, 1.000001).on_failure("should show Delta");
 }
 
+TEST(xfail_expect)  //{{{1
+{
+  vir::test::expect_failure();
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_COMPARE(i % 5 == 0 ? i + 1 : i, i) << "lane " << i;
+  }
+}
+
+TEST(xfail_soft_checks)  //{{{1
+{
+  vir::test::expect_failure();
+  vir::test::soft_checks();
+  for (int i = 0; i < 100; ++i) {
+    VERIFY(i < 0);
+  }
+}
+
+// Runs the checks in \p f with their output discarded and returns the number of failed
+// checks. Afterwards the current test continues as if none had failed.
+template <class F> static int count_failed_checks(F &&f)
+{
+  auto &tester = vir::test::detail::global_unit_test_object_;
+  std::ostringstream discard;
+  std::streambuf *const out = std::cout.rdbuf(discard.rdbuf());
+  try {
+    f();
+  } catch (const vir::test::detail::UnitTestFailure &) {
+  }
+  std::cout.rdbuf(out);
+  const int failed = tester.failed_checks;
+  tester.failed_checks = 0;
+  tester.soft_checks = false;
+  tester.status = true;
+  return failed;
+}
+
+TEST(soft_checks_continue)  //{{{1
+{
+  int iterations = 0;
+  COMPARE(count_failed_checks([&] {
+            for (int i = 0; i < 16; ++i) {
+              EXPECT_COMPARE(i % 5 == 0 ? i + 1 : i, i) << "lane " << i;
+              ++iterations;
+            }
+          }),
+          4);
+  COMPARE(iterations, 16);
+
+  const int max_failures = vir::test::detail::global_unit_test_object_.max_failures;
+  iterations = 0;
+  COMPARE(count_failed_checks([&] {
+            vir::test::soft_checks();
+            for (int i = 0; i < 100; ++i) {
+              ++iterations;
+              VERIFY(i < 0);
+            }
+          }),
+          max_failures);
+  COMPARE(iterations, max_failures);
+  EXPECT_VERIFY(true);
+}
+
+TEST(memcompare_range)  //{{{1
+{
+  std::vector<unsigned char> a(1000), b(1000);
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    a[i] = b[i] = static_cast<unsigned char>(i * 7);
+  }
+  MEMCOMPARE_RANGE(a.data(), b.data(), a.size());
+  COMPARE(vir::detail::first_mismatch(a.data(), b.data(), a.size()), a.size());
+  COMPARE(vir::detail::count_mismatches(a.data(), b.data(), a.size()), 0u);
+  // every position relative to the 16/32-byte blocks and the scalar tail
+  for (std::size_t i : {0, 1, 15, 16, 31, 32, 33, 63, 500, 990, 998, 999}) {
+    b[i] ^= 1;
+    COMPARE(vir::detail::first_mismatch(a.data(), b.data(), a.size()), i);
+    COMPARE(vir::detail::first_mismatch(a.data(), b.data(), a.size(), i + 1), a.size());
+    COMPARE(vir::detail::count_mismatches(a.data(), b.data(), a.size()), 1u);
+    b[i] ^= 1;
+  }
+  b[3] = b[40] = b[999] = 0xff;
+  COMPARE(vir::detail::count_mismatches(a.data(), b.data(), a.size()), 3u);
+  COMPARE(vir::detail::first_mismatch(a.data(), b.data(), a.size(), 4), 40u);
+  COMPARE(vir::detail::first_mismatch(a.data() + 4, b.data() + 4, 995), 36u);
+}
+
+TEST(xfail_memcompare_range)  //{{{1
+{
+  vir::test::expect_failure();
+  std::vector<float> a(100000, 1.f), b = a;
+  b[5] = 2.f;
+  b[77777] = 2.f;
+  MEMCOMPARE_RANGE(a.data(), b.data(), a.size());
+}
+
 TEST_CATCH(test_catch, int)  //{{{1
 {
   throw int();
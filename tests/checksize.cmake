@@ -0,0 +1,34 @@
+# Expects CXX (the compiler), SIZE (binutils size or llvm-size), SOURCE (checksize.cpp),
+# INCLUDE (the source dir), and BUDGETS (the allowed .text bytes per check for the
+# COMPARE(int), COMPARE(distinct type), and FUZZY_COMPARE(float) kinds, separated by '|').
+string(REPLACE "|" ";" budgets "${BUDGETS}")
+set(names "COMPARE(int)" "COMPARE(distinct type)" "FUZZY_COMPARE(float)")
+set(checks 64)
+
+function(text_size kind n result)
+   execute_process(
+      COMMAND ${CXX} -std=c++11 -O2 -I${INCLUDE} -DKIND=${kind} -DCHECKS=${n}
+         -c ${SOURCE} -o checksize.o
+      RESULT_VARIABLE ok
+      ERROR_VARIABLE error)
+   if(NOT ok EQUAL 0)
+      message(FATAL_ERROR "compiling ${SOURCE} with KIND=${kind} CHECKS=${n} failed:\n${error}")
+   endif()
+   execute_process(COMMAND ${SIZE} checksize.o OUTPUT_VARIABLE out RESULT_VARIABLE ok)
+   if(NOT ok EQUAL 0 OR NOT out MATCHES "\n *([0-9]+)")
+      message(FATAL_ERROR "${SIZE} checksize.o failed:\n${out}")
+   endif()
+   set(${result} ${CMAKE_MATCH_1} PARENT_SCOPE)
+endfunction()
+
+foreach(kind 0 1 2)
+   list(GET names ${kind} name)
+   list(GET budgets ${kind} budget)
+   text_size(${kind} 0 base)
+   text_size(${kind} ${checks} total)
+   math(EXPR per_check "(${total} - ${base}) / ${checks}")
+   if(per_check GREATER budget)
+      message(FATAL_ERROR "${name}: ${per_check} bytes of .text per check exceed the budget of ${budget}")
+   endif()
+   message(" PASS: ${name}: ${per_check} bytes of .text per check (budget ${budget})")
+endforeach()
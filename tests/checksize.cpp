@@ -0,0 +1,70 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+
+// Compiled by checksize.cmake with different CHECKS counts to measure the object code
+// each check adds. KIND selects the check: 0 = COMPARE(int), 1 = COMPARE of a distinct
+// type per check, 2 = FUZZY_COMPARE(float).
+#include <vir/test.h>
+
+template <int N> struct value {  //{{{1
+  int x;
+  bool operator==(const value &b) const { return x == b.x; }
+  friend std::ostream &operator<<(std::ostream &s, const value &v) { return s << v.x; }
+};
+
+template <int I> void check(int x, std::integral_constant<int, 0>)  //{{{1
+{
+  COMPARE(x, I);
+}
+template <int I> void check(int x, std::integral_constant<int, 1>)
+{
+  COMPARE(value<I>{x}, value<I>{I});
+}
+template <int I> void check(int x, std::integral_constant<int, 2>)
+{
+  FUZZY_COMPARE(float(x), float(I));
+}
+
+template <int I> struct checks {  //{{{1
+  static void run(int x)
+  {
+    check<I>(x + I, std::integral_constant<int, KIND>());
+    checks<I - 1>::run(x);
+  }
+};
+template <> struct checks<0> {
+  static void run(int) {}
+};
+
+TEST(checksize)  //{{{1
+{
+  checks<CHECKS>::run(vir::test::make_value_unknown(0));
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
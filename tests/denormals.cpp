@@ -0,0 +1,71 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+
+#include <vir/test.h>
+#include <cmath>
+#include <limits>
+
+using vir::detail::denormal_mode;
+
+TEST(denormal_mode_guard)  //{{{1
+{
+  const auto outer = vir::detail::get_denormal_mode();
+  for (auto mode : {denormal_mode::ieee, denormal_mode::ftz, denormal_mode::daz,
+                    denormal_mode::ftz_daz}) {
+    if (vir::detail::denormal_mode_supported(mode)) {
+      const vir::detail::denormal_mode_guard guard(mode);
+      COMPARE(unsigned(vir::detail::get_denormal_mode()), unsigned(mode));
+    }
+  }
+  COMPARE(unsigned(vir::detail::get_denormal_mode()), unsigned(outer));
+}
+
+// These tests pass in every mode of --denormal-modes.
+TEST_TYPES(T, flushed_result, float, double)  //{{{1
+{
+  using L = std::numeric_limits<T>;
+  const T quarter_min = L::min() / 4;  // constant folded, thus never flushed
+  // 0 with FTZ, otherwise quarter_min
+  FUZZY_COMPARE(vir::test::make_value_unknown(L::min()) * T(0.25), quarter_min);
+  if (vir::detail::get_denormal_mode() == denormal_mode::ieee) {
+    VERIFY(vir::detail::ulpDiffToReference(T(), quarter_min) > 0);
+  }
+}
+
+TEST_TYPES(T, denormal_difference, float, double)  //{{{1
+{
+  using L = std::numeric_limits<T>;
+  // the difference of these normal numbers is denormal and must not be flushed
+  const T a = vir::test::make_value_unknown(L::min());
+  const T b = std::nextafter(a, T(1));
+  COMPARE(vir::detail::ulpDiffToReference(b, a), T(1));
+  COMPARE(vir::detail::ulpDiffToReference(a, b), T(1));
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
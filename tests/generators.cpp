@@ -0,0 +1,121 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#include <vir/test.h>
+#include <vir/generators.h>
+
+#include <array>
+#include <cmath>
+#include <random>
+
+using vir::test::counter_rng;
+
+TEST(counter_rng_is_counter_based)  //{{{1
+{
+  counter_rng rng(1);
+  const counter_rng copy = rng;
+  for (std::uint64_t i = 0; i < 100; ++i) {
+    COMPARE(rng(), copy.at(i)) << "i = " << i;
+  }
+  COMPARE(rng.counter(), 100u);
+  counter_rng other(1);
+  other.discard(50);
+  COMPARE(other(), copy.at(50));
+}
+
+TEST(counter_rng_streams)  //{{{1
+{
+  const counter_rng rng(1);
+  VERIFY(rng.at(0) != counter_rng(2).at(0));
+  VERIFY(rng.split(0).at(0) != rng.split(1).at(0));
+  VERIFY(rng.split(0).at(0) != rng.at(0));
+  COMPARE(rng.split(7).at(3), counter_rng(1).split(7).at(3));
+
+  // usable with <random>
+  std::uniform_int_distribution<int> dist(0, 9);
+  counter_rng rng2(1);
+  for (int i = 0; i < 100; ++i) {
+    const int x = dist(rng2);
+    VERIFY(x >= 0 && x <= 9) << x;
+  }
+}
+
+TEST(sharded_fill)  //{{{1
+{
+  const counter_rng rng(42);
+  std::array<float, 64> whole, shards;
+  vir::test::fill(whole, vir::test::log_uniform<float>(), rng);
+  vir::test::fill(shards.begin(), shards.begin() + 20, vir::test::log_uniform<float>(), rng);
+  vir::test::fill(shards.begin() + 20, shards.end(), vir::test::log_uniform<float>(), rng,
+                  20);
+  MEMCOMPARE(whole, shards);
+}
+
+TEST_TYPES(T, distributions, float, double, long double)  //{{{1
+{
+  using L = std::numeric_limits<T>;
+  counter_rng rng = vir::test::test_rng();
+
+  const vir::test::log_uniform<T> log_uniform(-4, 4, false);
+  for (int i = 0; i < 1000; ++i) {
+    const T x = log_uniform(rng);
+    VERIFY(x >= T(1) / 16 && x < 32) << x;
+  }
+
+  const vir::test::subnormal<T> subnormal;
+  for (int i = 0; i < 1000; ++i) {
+    const T x = subnormal(rng);
+    COMPARE(std::fpclassify(x), FP_SUBNORMAL) << x;
+  }
+
+  const vir::test::near_special<T> near_special(2);
+  int n_nan = 0;
+  for (int i = 0; i < 1000; ++i) {
+    const T x = near_special(rng);
+    n_nan += std::isnan(x);
+    VERIFY(std::isnan(x) || std::isinf(x) || std::abs(x) <= L::max()) << x;
+  }
+  VERIFY(n_nan > 0);
+
+  const vir::test::uniform_bits<std::uint32_t> bits;
+  std::uint32_t all_ors = 0;
+  for (int i = 0; i < 100; ++i) {
+    all_ors |= bits(rng);
+  }
+  COMPARE(all_ors, ~std::uint32_t());
+}
+
+TEST(test_rng_replays)  //{{{1
+{
+  COMPARE(vir::test::test_rng().at(0), vir::test::test_rng().at(0));
+  COMPARE(vir::test::test_rng().key(),
+          counter_rng(vir::test::random_seed(), vir::detail::hash_name("test_rng_replays"))
+              .key());
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
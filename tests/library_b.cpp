@@ -0,0 +1,54 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+
+#include <vir/test.h>
+#include <type_traits>
+#include <vector>
+
+TEST(library_b)  //{{{1
+{
+  std::vector<int> v = {1, 2, 3};
+  COMPARE(v.size(), 3u);
+  MEMCOMPARE_RANGE(v.data(), v.data(), v.size());
+}
+
+// library mode requires VIR_COMPILE_TIME_SEED for random choices (see CMakeLists.txt)
+using Integers = vir::Typelist<short, int, long>;
+TEST_TYPES(T, library_b_random, VIR_CHOOSE_ONE_RANDOMLY(Integers))  //{{{1
+{
+  VERIFY(std::is_integral<T>::value);
+}
+
+TEST(library_b_xfail)  //{{{1
+{
+  vir::test::expect_failure();
+  COMPARE(1, 2);
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
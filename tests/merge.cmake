@@ -0,0 +1,47 @@
+# Runs the two shards of the rerun test and merges their results with virtest-merge.
+file(REMOVE shard0.results shard1.results)
+foreach(shard 0 1)
+   execute_process(
+      COMMAND ./rerun --state-file= --shard ${shard}/2 --results shard${shard}.results
+      OUTPUT_VARIABLE output)
+   if(NOT EXISTS shard${shard}.results)
+      message(FATAL_ERROR "shard ${shard} did not write its results:\n${output}")
+   endif()
+endforeach()
+file(READ shard0.results results)
+if(NOT results MATCHES "\tpasses_a\n.*\tpasses_b\nEND\t2\t0\t0\n$")
+   message(FATAL_ERROR "unexpected results of shard 0:\n${results}")
+endif()
+
+execute_process(
+   COMMAND ${MERGE} shard0.results shard1.results
+   RESULT_VARIABLE failed
+   OUTPUT_VARIABLE output)
+if(NOT failed EQUAL 1 OR
+      NOT output MATCHES "FAIL: fixed_later \\(shard1.results\\)" OR
+      NOT output MATCHES "Testing done. 2 tests passed. 1 tests failed. 0 tests skipped.")
+   message(FATAL_ERROR "unexpected merge of the shards (exit code ${failed}):\n${output}")
+endif()
+
+# a run that did not reach finalize() counts as a failure
+file(WRITE crashed.results "# virtest results 1\nTEST\tPASS\t0.1\t0\t0\t0\tfirst\n")
+execute_process(
+   COMMAND ${MERGE} shard0.results crashed.results
+   RESULT_VARIABLE failed
+   OUTPUT_VARIABLE output)
+if(NOT failed EQUAL 1 OR NOT output MATCHES "crashed.results is incomplete" OR
+      NOT output MATCHES "Testing done. 3 tests passed. 1 tests failed.")
+   message(FATAL_ERROR "an incomplete results file was not reported:\n${output}")
+endif()
+
+# an unwritable --results file is an error, not a silently missing shard
+execute_process(
+   COMMAND ./rerun --state-file= --results no_such_directory/shard.results
+   RESULT_VARIABLE ok
+   OUTPUT_VARIABLE output
+   ERROR_VARIABLE error)
+if(NOT ok EQUAL 1 OR NOT error MATCHES "--results: cannot open no_such_directory/shard.results")
+   message(FATAL_ERROR "unwritable --results file not reported (exit code ${ok}):\n${error}")
+endif()
+
+message(" PASS: --shard, --results, and virtest-merge work as expected")
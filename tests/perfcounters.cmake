@@ -0,0 +1,32 @@
+file(REMOVE perf.tsv)
+
+execute_process(
+   COMMAND ./perfcounters -v --perf-counters cycles,instructions --perf-output perf.tsv
+   RESULT_VARIABLE ok
+   OUTPUT_VARIABLE output)
+if(NOT ok EQUAL 0 OR NOT output MATCHES "Testing done. 1 tests passed. 0 tests failed")
+   message(FATAL_ERROR "--perf-counters must not change the test results:\n${output}")
+endif()
+file(READ perf.tsv perf)
+
+if(output MATCHES "perf counters unavailable")
+   # e.g. perf_event_paranoid or a VM without PMU: the tests run without counters
+   if(output MATCHES "\\[cycles=" OR NOT perf STREQUAL "")
+      message(FATAL_ERROR "counts reported without counters:\n${output}\n${perf}")
+   endif()
+   message(" PASS: perf counters unavailable, the tests ran without")
+   return()
+endif()
+
+set(counts "\\[cycles=[0-9]+ instructions=[0-9]+( scaled, counted [0-9]+% of the time)?\\]")
+if(NOT output MATCHES "PASS: counts_work ${counts}\n")
+   message(FATAL_ERROR "counts missing on the PASS line:\n${output}")
+endif()
+if(NOT output MATCHES "XFAIL: xfail_keeps_counts ${counts}\n")
+   message(FATAL_ERROR "counts missing on the XFAIL line:\n${output}")
+endif()
+if(NOT perf MATCHES "^counts_work\tcycles\t[0-9]+\ncounts_work\tinstructions\t[0-9]+\nxfail_keeps_counts\tcycles\t[0-9]+\nxfail_keeps_counts\tinstructions\t[0-9]+\n$")
+   message(FATAL_ERROR "unexpected --perf-output file:\n${perf}")
+endif()
+
+message(" PASS: perf counters are reported and written to --perf-output")
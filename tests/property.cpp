@@ -0,0 +1,111 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#include <vir/test.h>
+#include <vir/property.h>
+
+#include <cmath>
+
+TEST_PROPERTY(abs_is_nonnegative, (float x), vir::test::log_uniform<float>())  //{{{1
+{
+  VERIFY(std::abs(x) >= 0) << x;
+}
+
+TEST_PROPERTY(addition_commutes, (int a, int b),  //{{{1
+              vir::test::uniform_bits<short>(), vir::test::uniform_bits<short>())
+{
+  COMPARE(a + b, b + a);
+}
+
+TEST_PROPERTY(skip_discards, (double x), vir::test::near_special<double>())  //{{{1
+{
+  if (std::isnan(x)) {
+    vir::test::SKIP();
+  }
+  COMPARE(x, x);
+}
+
+// shrinking {{{1
+struct less_than_1000 {
+  void operator()(unsigned x) const { VERIFY(x < 1000); }
+};
+
+struct fraction_below_2 {
+  void operator()(float x) const { VERIFY(!(x >= 2.f)); }
+};
+
+TEST(shrink_to_minimal_counterexample)
+{
+  using vir::test::detail::property_runner;
+  const property_runner<less_than_1000, vir::test::uniform_bits<unsigned>> ints{
+      less_than_1000(), vir::test::uniform_bits<unsigned>()};
+  const std::size_t first = ints.find_first_failure(1000);
+  VERIFY(first < 1000);
+  auto args = ints.generate(first);
+  ints.shrink(args);
+  COMPARE(std::get<0>(args), 1000u);
+
+  const property_runner<fraction_below_2, vir::test::log_uniform<float>> floats{
+      fraction_below_2(), vir::test::log_uniform<float>()};
+  auto fargs = floats.generate(floats.find_first_failure(1000));
+  floats.shrink(fargs);
+  COMPARE(std::get<0>(fargs), 2.f);
+}
+
+TEST(find_first_failure_is_deterministic)  //{{{1
+{
+  using vir::test::detail::property_runner;
+  const property_runner<less_than_1000, vir::test::uniform_bits<unsigned>> runner{
+      less_than_1000(), vir::test::uniform_bits<unsigned>()};
+  const std::size_t first = runner.find_first_failure(1000);
+  COMPARE(runner.find_first_failure(1000), first);
+  for (std::size_t i = 0; i < first; ++i) {
+    VERIFY(!runner.fails(runner.generate(i)));
+  }
+  VERIFY(runner.fails(runner.generate(first)));
+}
+
+TEST(xfail_property)  //{{{1
+{
+  vir::test::expect_failure();
+  vir::test::detail::check_property(less_than_1000(), __FILE__, __LINE__,
+                                    vir::test::uniform_bits<unsigned>());
+}
+
+struct expect_less_than_1000 {
+  void operator()(unsigned x) const { EXPECT_VERIFY(x < 1000); }
+};
+
+TEST(xfail_soft_property)  //{{{1
+{
+  vir::test::expect_failure();
+  vir::test::detail::check_property(expect_less_than_1000(), __FILE__, __LINE__,
+                                    vir::test::uniform_bits<unsigned>());
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
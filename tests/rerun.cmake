@@ -0,0 +1,75 @@
+file(REMOVE rerun.state)
+
+execute_process(
+   COMMAND ./rerun --state-file rerun.state
+   RESULT_VARIABLE ok
+   OUTPUT_VARIABLE output)
+if(NOT ok EQUAL 1)
+   message(FATAL_ERROR "expected exactly one failure, got ${ok}:\n${output}")
+endif()
+file(READ rerun.state state)
+if(NOT state STREQUAL "FAIL\tfixed_later\n")
+   message(FATAL_ERROR "unexpected state file:\n${state}")
+endif()
+
+# --failed-first runs the failed test first, then the rest
+execute_process(
+   COMMAND ./rerun --state-file rerun.state --failed-first
+   OUTPUT_VARIABLE output)
+if(NOT output MATCHES "fixed_later.*passes_a.*passes_b")
+   message(FATAL_ERROR "--failed-first did not start with the failed test:\n${output}")
+endif()
+
+# --rerun-failed runs only the failed test
+execute_process(
+   COMMAND ${CMAKE_COMMAND} -E env VIR_RERUN_FIXED=1
+           ./rerun --state-file=rerun.state --rerun-failed
+   RESULT_VARIABLE ok
+   OUTPUT_VARIABLE output)
+if(NOT ok EQUAL 0 OR NOT output MATCHES "Testing done. 1 tests passed. 0 tests failed")
+   message(FATAL_ERROR "--rerun-failed did not run only the failed test:\n${output}")
+endif()
+file(READ rerun.state state)
+if(NOT state STREQUAL "")
+   message(FATAL_ERROR "the fixed test is still recorded:\n${state}")
+endif()
+
+# without recorded failures --rerun-failed runs everything
+execute_process(
+   COMMAND ${CMAKE_COMMAND} -E env VIR_RERUN_FIXED=1
+           ./rerun --state-file rerun.state --rerun-failed
+   OUTPUT_VARIABLE output)
+if(NOT output MATCHES "Testing done. 3 tests passed. 0 tests failed")
+   message(FATAL_ERROR "--rerun-failed without failures did not run all tests:\n${output}")
+endif()
+
+# skipped tests and failures of tests that no longer exist are not rerun
+file(WRITE rerun.state "SKIP\tpasses_a\nFAIL\tremoved_test\n")
+execute_process(
+   COMMAND ./rerun --state-file rerun.state --rerun-failed
+   OUTPUT_VARIABLE output)
+if(NOT output MATCHES "Testing done. 2 tests passed. 1 tests failed")
+   message(FATAL_ERROR "--rerun-failed without registered failures did not run all tests:\n${output}")
+endif()
+
+# without a state option no state file is written
+file(REMOVE_RECURSE rerun_cwd)
+file(MAKE_DIRECTORY rerun_cwd)
+execute_process(
+   COMMAND ../rerun
+   WORKING_DIRECTORY rerun_cwd
+   OUTPUT_VARIABLE output)
+if(EXISTS rerun_cwd/rerun.last-run)
+   message(FATAL_ERROR "a state file was written without --state-file, --rerun-failed or --failed-first")
+endif()
+
+# the default state file of --failed-first is written to the working directory
+execute_process(
+   COMMAND ../rerun --failed-first
+   WORKING_DIRECTORY rerun_cwd
+   OUTPUT_VARIABLE output)
+if(NOT EXISTS rerun_cwd/rerun.last-run)
+   message(FATAL_ERROR "the state file was not written to the working directory")
+endif()
+
+message(" PASS: --rerun-failed and --failed-first work as expected")
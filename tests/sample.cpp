@@ -0,0 +1,118 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+
+#include <vir/test.h>
+
+#include <algorithm>
+
+using vir::test::detail::TestData;
+
+// helpers {{{1
+static std::vector<TestData> fake_tests()
+{
+  std::vector<TestData> tests;
+  const char *names[] = {"a",    "b<int>", "b<float>", "b<char>", "c<0>", "c<1>", "c<2>",
+                         "c<3>", "c<4>",   "c<5>",     "c<6>",    "c<7>", "c<8>", "c<9>"};
+  for (const char *name : names) {
+    tests.emplace_back(vir::test::detail::TestFunction(), name);
+  }
+  return tests;
+}
+
+// runs sampleTests with the given settings and restores the runner's settings
+static std::vector<bool> sample(std::size_t count, double fraction, std::uint64_t seed)
+{
+  auto &tester = vir::test::detail::global_unit_test_object_;
+  auto &random = vir::detail::global_random_state();
+  const auto saved_count = tester.sample_count;
+  const auto saved_fraction = tester.sample_fraction;
+  const auto saved_seed = random.seed;
+  tester.sample_count = count;
+  tester.sample_fraction = fraction;
+  random.seed = seed;
+  const auto chosen = vir::test::detail::sampleTests(fake_tests());
+  tester.sample_count = saved_count;
+  tester.sample_fraction = saved_fraction;
+  random.seed = saved_seed;
+  return chosen;
+}
+
+static std::size_t count_of(const std::vector<bool> &chosen, std::size_t first,
+                            std::size_t last)
+{
+  return std::count(chosen.begin() + first, chosen.begin() + last, true);
+}
+
+TEST(sample_size)  //{{{1
+{
+  for (std::uint64_t seed = 0; seed < 20; ++seed) {
+    COMPARE(count_of(sample(0, 0, seed), 0, 14), 14u);
+    COMPARE(count_of(sample(5, 0, seed), 0, 14), 5u) << "seed " << seed;
+    COMPARE(count_of(sample(0, 0.5, seed), 0, 14), 7u) << "seed " << seed;
+    COMPARE(count_of(sample(0, 1., seed), 0, 14), 14u) << "seed " << seed;
+    COMPARE(count_of(sample(100, 0, seed), 0, 14), 14u) << "seed " << seed;
+  }
+}
+
+TEST(sample_is_stratified)  //{{{1
+{
+  for (std::uint64_t seed = 0; seed < 20; ++seed) {
+    // one instantiation per test function, even if the sample is smaller
+    const auto chosen = sample(1, 0, seed);
+    COMPARE(count_of(chosen, 0, 14), 3u) << "seed " << seed;
+    VERIFY(chosen[0]);
+    COMPARE(count_of(chosen, 1, 4), 1u) << "seed " << seed;
+    COMPARE(count_of(chosen, 4, 14), 1u) << "seed " << seed;
+  }
+}
+
+TEST(sample_depends_on_seed)  //{{{1
+{
+  COMPARE(sample(5, 0, 42), sample(5, 0, 42));
+  // over many seeds every instantiation is sampled
+  std::vector<int> runs(14, 0);
+  for (std::uint64_t seed = 0; seed < 50; ++seed) {
+    const auto chosen = sample(5, 0, seed);
+    for (std::size_t i = 0; i < chosen.size(); ++i) {
+      runs[i] += chosen[i];
+    }
+  }
+  for (int n : runs) {
+    VERIFY(n > 0);
+  }
+}
+
+// with --sample only some of these run
+TEST_TYPES(T, instantiations,
+           vir::outer_product<vir::Typelist<float, double>,
+                              vir::Typelist<char, short, int, long>>)  //{{{1
+{
+  VERIFY(T::size() == 2);
+}
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
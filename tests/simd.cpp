@@ -0,0 +1,96 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#include <experimental/simd>
+#include <vir/test.h>
+
+namespace stdx = std::experimental;
+
+using simd_types = vir::Typelist<stdx::native_simd<float>, stdx::native_simd<double>,
+                                 stdx::fixed_size_simd<float, 3>, stdx::simd<int>>;
+
+TEST(simd_type_to_string)  //{{{1
+{
+  COMPARE((vir::typeToString<stdx::fixed_size_simd<int, 3>>()),
+          "simd<   int, fixed_size<3>>");
+  COMPARE((vir::typeToString<stdx::fixed_size_simd_mask<int, 3>>()),
+          "simd_mask<   int, fixed_size<3>>");
+#ifdef _GLIBCXX_EXPERIMENTAL_SIMD
+  COMPARE((vir::typeToString<stdx::simd<float, stdx::simd_abi::scalar>>()),
+          "simd< float, _Scalar>");
+#if defined __SSE2__ && !defined __AVX512F__
+  COMPARE((vir::typeToString<stdx::simd<float, stdx::simd_abi::_VecBuiltin<16>>>()),
+          "simd< float, _VecBuiltin<16>>");
+#endif
+#endif
+}
+
+TEST_TYPES(V, simd_compare, simd_types)  //{{{1
+{
+  using T = typename V::value_type;
+  const V iota([](T i) { return i; });
+  COMPARE(iota, iota);
+  COMPARE(iota == iota, typename V::mask_type(true));
+  using traits = vir::test::compare_traits<V, V>;
+  VERIFY(!traits::is_equal(iota, iota + 1));
+}
+
+TEST_TYPES(V, simd_fuzzy_compare, simd_types)  //{{{1
+{
+  using T = typename V::value_type;
+  if constexpr (std::is_floating_point_v<T>) {
+    const V x([](T i) { return T(1) + i; });
+    V y = x;
+    where(x == 2, y) *= 1 + std::numeric_limits<T>::epsilon();
+    FUZZY_COMPARE(y, x);
+    const V ulp = vir::test::compare_traits<V, V>::ulp_distance(y, x);
+    COMPARE(ulp[0], T(0));
+    if (V::size() > 1) {
+      COMPARE(ulp[1], T(1));
+    }
+  }
+}
+
+TEST(simd_mismatched_lanes)  //{{{1
+{
+  const stdx::fixed_size_simd<int, 8> a([](int i) { return i; });
+  const stdx::fixed_size_simd<int, 8> b([](int i) { return i % 3 == 1 ? -i : i; });
+  COMPARE(vir::test::detail::mismatched_lanes(a == b), "1, 4, 7");
+  COMPARE(vir::test::detail::mismatched_lanes(a == a), "");
+}
+
+TEST(xfail_simd_compare)  //{{{1
+{
+  vir::test::expect_failure();
+  const stdx::native_simd<float> a([](int i) { return i; });
+  auto b = a;
+  where(a == 1, b) += 1;
+  COMPARE(a, b);
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
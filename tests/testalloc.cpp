@@ -0,0 +1,136 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#include <vir/test.h>
+#include <vir/testalloc.h>
+
+#include <memory>
+#include <new>
+#include <vector>
+
+TEST(count_allocations)  //{{{1
+{
+  using vir::test::current_allocation_stats;
+  COMPARE(current_allocation_stats().allocations, 0u);
+  {
+    std::vector<int> v(100);
+    std::unique_ptr<double> p(new double(1.));
+    COMPARE(v.size() + 1, 101u);
+  }
+  const auto stats = current_allocation_stats();
+  COMPARE(stats.allocations, 2u);
+  COMPARE(stats.bytes, 100 * sizeof(int) + sizeof(double));
+  COMPARE(stats.peak, stats.bytes);
+
+  std::vector<char> a(1000);
+  std::vector<char>().swap(a);
+  std::vector<char> b(1000);
+  COMPARE(current_allocation_stats().peak, 1000u);
+  std::vector<char> c(1000);
+  COMPARE(current_allocation_stats().peak, 2000u);
+}
+
+TEST(stats_reset_per_test)  //{{{1
+{
+  COMPARE(vir::test::current_allocation_stats().allocations, 0u);
+  COMPARE(vir::test::current_allocation_stats().peak, 0u);
+}
+
+static int new_handler_calls = 0;
+
+TEST(nothrow_calls_new_handler)  //{{{1
+{
+  // larger than any address space: every attempt fails
+  volatile std::size_t huge = std::size_t(1) << (sizeof(std::size_t) * 8 - 2);
+  std::set_new_handler([] {
+    if (++new_handler_calls == 3) {
+      std::set_new_handler(nullptr);
+    }
+  });
+  void *p = ::operator new(huge, std::nothrow);
+  COMPARE(p, nullptr);
+  COMPARE(new_handler_calls, 3);
+  COMPARE(vir::test::current_allocation_stats().allocations, 0u);
+}
+
+#if __cpp_aligned_new
+TEST(aligned_allocation)  //{{{1
+{
+  struct alignas(64) line {
+    char data[64];
+  };
+  std::vector<line> v(3);
+  COMPARE(reinterpret_cast<std::uintptr_t>(v.data()) % 64, 0u);
+  COMPARE(vir::test::current_allocation_stats().bytes, 3 * sizeof(line));
+}
+
+TEST(aligned_nothrow_allocation)  //{{{1
+{
+  struct alignas(64) line {
+    char data[64];
+  };
+  line *p = new (std::nothrow) line[2];  // operator new[](size, align_val_t, nothrow_t)
+  VERIFY(p != nullptr);
+  COMPARE(reinterpret_cast<std::uintptr_t>(p) % 64, 0u);
+  COMPARE(vir::test::current_allocation_stats().allocations, 1u);
+  delete[] p;
+  void *raw = ::operator new(64, std::align_val_t(128), std::nothrow);
+  COMPARE(reinterpret_cast<std::uintptr_t>(raw) % 128, 0u);
+  ::operator delete(raw, std::align_val_t(128), std::nothrow);
+  COMPARE(vir::test::current_allocation_stats().allocations, 2u);
+}
+#endif
+
+TEST(no_alloc_scope_passes)  //{{{1
+{
+  std::vector<int> v;
+  v.reserve(16);
+  {
+    vir::test::no_alloc_scope guard;
+    for (int i = 0; i < 16; ++i) {
+      v.push_back(i);
+    }
+  }
+  COMPARE(NO_ALLOC(v[3] + v[4]), 7);
+}
+
+TEST(no_alloc_scope_fails)  //{{{1
+{
+  vir::test::expect_failure();
+  std::vector<int> v;
+  vir::test::no_alloc_scope guard;
+  v.push_back(1);
+}
+
+TEST(NO_ALLOC_fails)  //{{{1
+{
+  vir::test::expect_failure();
+  NO_ALLOC(std::vector<int>(1));
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
@@ -0,0 +1,138 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+
+#include <vir/test.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(passing_checks_on_threads)  //{{{1
+{
+  std::vector<vir::test::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([t]() {
+      for (int i = 0; i < 10000; ++i) {
+        COMPARE(i + t, t + i);
+        VERIFY(i >= 0);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+TEST(failure_on_std_thread)  //{{{1
+{
+  vir::test::expect_failure();
+  // the check must neither call std::terminate nor end the thread
+  bool continued = false;
+  std::thread worker([&]() {
+    COMPARE(1, 2) << "on a std::thread";
+    continued = true;
+  });
+  worker.join();
+  VERIFY(continued);
+}
+
+std::atomic<bool> continued_after_failure(false);
+TEST(failure_on_checked_thread)  //{{{1
+{
+  vir::test::expect_failure();
+  vir::test::thread worker([]() {
+    COMPARE(1, 2) << "on a vir::test::thread";
+    continued_after_failure = true;
+  });
+  worker.join();  // rethrows the failure
+  FAIL() << "join() did not rethrow the failure";
+}
+
+TEST(failure_ends_checked_thread)  //{{{1
+{
+  VERIFY(!continued_after_failure);
+}
+
+TEST(soft_failure_on_checked_thread)  //{{{1
+{
+  vir::test::expect_failure();
+  bool continued = false;
+  vir::test::thread worker([&]() {
+    EXPECT_COMPARE(1, 2);
+    continued = true;
+  });
+  worker.join();
+  VERIFY(continued);
+}
+
+TEST(concurrent_failures)  //{{{1
+{
+  vir::test::expect_failure();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([t]() {
+      for (int i = 0; i < 100; ++i) {
+        COMPARE(t, -1) << "thread " << t << ", iteration " << i;
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+TEST(exception_on_checked_thread)  //{{{1
+{
+  vir::test::thread worker([]() { throw std::runtime_error("from the worker"); });
+  bool caught = false;
+  try {
+    worker.join();
+  } catch (const std::runtime_error &e) {
+    caught = true;
+    COMPARE(std::string(e.what()), "from the worker");
+  }
+  VERIFY(caught);
+}
+
+TEST(unjoined_exception_on_checked_thread)  //{{{1
+{
+  vir::test::expect_failure();
+  // the destructor joins and must report the exception instead of dropping it
+  vir::test::thread worker([]() { throw std::runtime_error("never rethrown"); });
+}
+
+TEST(checked_thread_arguments)  //{{{1
+{
+  int result = 0;
+  vir::test::thread worker([](int a, int *out) { *out = a * 2; }, 21, &result);
+  worker.join();
+  COMPARE(result, 42);
+}
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
@@ -0,0 +1,63 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#include <vir/test.h>
+
+#include <chrono>
+#include <thread>
+
+// Every test runs in a child process with --timeout, so the run continues after a test
+// timed out.
+
+TEST(spins_forever)  //{{{1
+{
+  vir::test::set_timeout(0.1);
+  int x = 1;
+  EXPECT_COMPARE(x, 2);  // the last failed check before the timeout
+  for (;;) {
+    vir::test::do_not_optimize(x);
+  }
+}
+
+TEST(sleeps_briefly)  //{{{1
+{
+  VERIFY(true);
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+}
+
+TEST(finishes_in_time)  //{{{1
+{
+  VERIFY(true);
+}
+
+TEST(crashes)  //{{{1
+{
+  std::abort();
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
@@ -0,0 +1,99 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+
+// a fixed seed makes the choices below reproducible (see VIR_COMPILE_TIME_SEED)
+#ifndef VIR_COMPILE_TIME_SEED
+#define VIR_COMPILE_TIME_SEED 12345
+#endif
+#include <vir/test.h>
+
+using vir::Typelist;
+using List = Typelist<char, short, int, long, float, double, Typelist<int, float>>;
+
+// helpers {{{1
+template <class T, class L> struct index_of;
+template <class T, class... Ts> struct index_of<T, Typelist<T, Ts...>> {
+  static constexpr int value = 0;
+};
+template <class T, class U, class... Ts> struct index_of<T, Typelist<U, Ts...>> {
+  static constexpr int value = 1 + index_of<T, Typelist<Ts...>>::value;
+};
+
+// whether every entry of the first list occurs in List, in the same order and only once
+template <int Previous, class L> struct is_ordered_subset : std::true_type {
+};
+template <int Previous, class T, class... Ts>
+struct is_ordered_subset<Previous, Typelist<T, Ts...>>
+    : std::integral_constant<bool, (Previous < index_of<T, List>::value) &&
+                                       is_ordered_subset<index_of<T, List>::value,
+                                                         Typelist<Ts...>>::value> {
+};
+
+inline void count(int *, Typelist<>) {}
+template <class T, class... Ts> void count(int *counts, Typelist<T, Ts...>)
+{
+  ++counts[index_of<T, List>::value];
+  count(counts, Typelist<Ts...>());
+}
+
+inline void count_choices(int *, std::integral_constant<unsigned, 0>) {}
+template <unsigned K1> void count_choices(int *counts, std::integral_constant<unsigned, K1>)
+{
+  count(counts, vir::compile_time_rand::choose_k<2, List, 0, K1>());
+  count_choices(counts, std::integral_constant<unsigned, K1 - 1>());
+}
+
+TEST(compile_time_seed)  //{{{1
+{
+  COMPARE(vir::compile_time_rand::seed(), unsigned(VIR_COMPILE_TIME_SEED));
+}
+
+TEST(choose_k)  //{{{1
+{
+  using vir::compile_time_rand;
+  static_assert(compile_time_rand::choose_k<0, List>::size() == 0, "");
+  static_assert(std::is_same<compile_time_rand::choose_k<7, List>, List>::value, "");
+
+  using Three = VIR_CHOOSE_K_RANDOMLY(3, List);
+  COMPARE(Three::size(), 3u);
+  VERIFY((is_ordered_subset<-1, Three>::value)) << vir::typeToString<Three>();
+
+  // different template arguments (i.e. different lines) make different choices
+  int chosen[List::size()] = {};
+  count_choices(chosen, std::integral_constant<unsigned, 32>());
+  for (int n : chosen) {
+    VERIFY(n > 0);
+  }
+}
+
+TEST_TYPES(T, chosen_types, VIR_CHOOSE_K_RANDOMLY(2, List))  //{{{1
+{
+  VERIFY((index_of<T, List>::value >= 0));
+}
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
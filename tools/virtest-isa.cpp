@@ -0,0 +1,92 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+
+/**
+ * virtest-isa: runs a test executable built for an x86-64 micro-architecture level
+ * (-march=x86-64-v<N>) if the CPU supports that level. Otherwise it prints a SKIP line
+ * and exits with 77, which vir_add_isa_tests registers as SKIP_RETURN_CODE.
+ *
+ * Usage: virtest-isa <level> <executable> [<args>...]
+ *
+ * The environment variable VIRTEST_ISA_MAX=<level> lowers the supported level, e.g. to
+ * check the skipping on a newer machine. An unknown level is an error (exit code 1).
+ */
+
+#include <vir/detail/isa_level.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#if defined __unix__ || defined __APPLE__
+#include <unistd.h>
+#endif
+
+int main(int argc, char **argv)  //{{{1
+{
+  if (argc < 3 || 0 == std::strcmp(argv[1], "--help") || 0 == std::strcmp(argv[1], "-h")) {
+    std::cout << "Usage: " << argv[0] << " <level> <executable> [<args>...]\n";
+    return argc < 3 ? 1 : 0;
+  }
+  const int level = vir::detail::parse_isa_level(argv[1]);
+  if (level == 0) {
+    std::cout << " FAIL: unknown ISA level " << argv[1] << '\n';
+    return 1;
+  }
+  int host = vir::detail::host_isa_level();
+  if (const char *max = std::getenv("VIRTEST_ISA_MAX")) {
+    const int max_level = vir::detail::parse_isa_level(max);
+    if (max_level == 0) {
+      // a typo must not turn every ISA test into a SKIP
+      std::cout << " FAIL: unknown ISA level in VIRTEST_ISA_MAX=" << max << '\n';
+      return 1;
+    }
+    host = max_level < host ? max_level : host;
+  }
+  if (level > host) {
+    std::cout << " SKIP: " << argv[2] << ": the CPU does not support " << argv[1] << '\n';
+    return 77;
+  }
+  std::cout << "-------- ISA level " << argv[1] << " --------" << std::endl;
+#if defined __unix__ || defined __APPLE__
+  execv(argv[2], argv + 2);
+  std::cout << " FAIL: cannot execute " << argv[2] << '\n';
+  return 1;
+#else
+  std::string command;
+  for (int i = 2; i < argc; ++i) {
+    command += std::string(i > 2 ? " \"" : "\"") + argv[i] + '"';
+  }
+  const int status = std::system(command.c_str());
+  return status < 0 ? 1 : status;
+#endif
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
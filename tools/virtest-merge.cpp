@@ -0,0 +1,112 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+/**
+ * virtest-merge: combines the --results files of several runs (e.g. one per --shard) into
+ * one summary. The exit code is the total number of failed tests.
+ *
+ * Usage: virtest-merge <results file>...
+ */
+
+#include <vir/detail/results.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+int main(int argc, char **argv)  //{{{1
+{
+  if (argc < 2 || 0 == std::strcmp(argv[1], "--help") || 0 == std::strcmp(argv[1], "-h")) {
+    std::cout << "Usage: " << argv[0] << " <results file>...\n";
+    return argc < 2 ? 1 : 0;
+  }
+  long passed = 0, failed = 0, skipped = 0;
+  double max_ulp = 0, sum_ulp = 0;
+  long ulp_count = 0;
+  double total_seconds = 0;
+  vir::detail::test_result slowest;
+  for (int i = 1; i < argc; ++i) {
+    std::ifstream file(argv[i]);
+    std::string line;
+    if (!std::getline(file, line) || line != vir::detail::results_header) {
+      std::cout << " FAIL: " << argv[i] << " is not a results file\n";
+      ++failed;
+      continue;
+    }
+    bool complete = false;
+    long file_passed = 0, file_failed = 0, file_skipped = 0;
+    while (std::getline(file, line)) {
+      vir::detail::test_result r;
+      if (vir::detail::parse_result(line, r)) {
+        if (r.status == "PASS") {
+          ++file_passed;
+        } else if (r.status == "FAIL") {
+          ++file_failed;
+          std::cout << " FAIL: " << r.name << " (" << argv[i] << ")\n";
+        } else if (r.status == "SKIP") {
+          ++file_skipped;
+        }
+        if (r.max_ulp > max_ulp) {
+          max_ulp = r.max_ulp;
+        }
+        sum_ulp += r.sum_ulp;
+        ulp_count += r.ulp_count;
+        total_seconds += r.seconds;
+        if (r.seconds > slowest.seconds) {
+          slowest = r;
+        }
+      } else if (0 == line.compare(0, 4, "END\t")) {
+        // the totals of finalize() also include ADD_PASS
+        std::istringstream in(line.substr(4));
+        in >> file_passed >> file_failed >> file_skipped;
+        complete = true;
+      }
+    }
+    if (!complete) {
+      std::cout << " FAIL: " << argv[i] << " is incomplete, the run did not finish\n";
+      ++file_failed;
+    }
+    passed += file_passed;
+    failed += file_failed;
+    skipped += file_skipped;
+  }
+  if (ulp_count > 0) {
+    std::cout << "\n maximal distance to the reference: " << max_ulp
+              << " (mean: " << sum_ulp / ulp_count << ")";
+  }
+  std::cout << "\n " << argc - 1 << " result files, test time: " << total_seconds << " s";
+  if (!slowest.name.empty()) {
+    std::cout << ", slowest: " << slowest.name << " (" << slowest.seconds << " s)";
+  }
+  std::cout << "\n\n Testing done. " << passed << " tests passed. " << failed
+            << " tests failed. " << skipped << " tests skipped." << std::endl;
+  return static_cast<int>(failed);
+}
+
+//}}}1
+// vim: sw=2 et sts=2 foldmethod=marker
@@ -0,0 +1,758 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#ifndef VIR_BENCHMARK_H_
+#define VIR_BENCHMARK_H_
+
+#include "test.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined __x86_64__ || defined __i386__ || defined _M_X64 || defined _M_IX86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define VIR_HAVE_TSC 1
+#endif
+
+namespace vir
+{
+namespace test
+{
+namespace detail
+{
+// tsc / ticks_per_second {{{1
+/**\internal
+ * The time stamp counter on x86, nanoseconds of steady_clock otherwise.
+ */
+VIR_ALWAYS_INLINE std::uint64_t tsc()
+{
+#ifdef VIR_HAVE_TSC
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+inline double ticks_per_second()
+{
+#ifdef VIR_HAVE_TSC
+  static const double r = [] {
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    const std::uint64_t c0 = tsc();
+    while (clock::now() - t0 < std::chrono::milliseconds(20)) {
+    }
+    const std::uint64_t c1 = tsc();
+    const std::chrono::duration<double> dt = clock::now() - t0;
+    return (c1 - c0) / dt.count();
+  }();
+  return r;
+#else
+  return 1e9;
+#endif
+}
+
+// keep_result {{{1
+/**\internal
+ * Forces the compiler to compute \p x (the result of the benchmarked function).
+ */
+template <class T> VIR_ALWAYS_INLINE void keep_result(const T &x)
+{
+  do_not_optimize(x);
+  clobber_memory();
+}
+
+// sample statistics {{{1
+struct sample_stats {
+  double median;
+  double mad;  // median absolute deviation
+  std::size_t outliers;
+};
+
+inline double median_of(std::vector<double> v)
+{
+  if (v.empty()) {
+    return 0;
+  }
+  const std::size_t mid = v.size() / 2;
+  std::nth_element(v.begin(), v.begin() + mid, v.end());
+  if (v.size() % 2 == 1) {
+    return v[mid];
+  }
+  return (v[mid] + *std::max_element(v.begin(), v.begin() + mid)) / 2;
+}
+
+inline double mad_of(const std::vector<double> &v, double median)
+{
+  std::vector<double> dev;
+  dev.reserve(v.size());
+  for (double x : v) {
+    dev.push_back(x > median ? x - median : median - x);
+  }
+  return median_of(std::move(dev));
+}
+
+/**\internal
+ * Drops samples further than 3σ (estimated as 1.4826 MAD) from the median and returns median
+ * and MAD of the remaining samples.
+ */
+inline sample_stats summarize(std::vector<double> &samples)
+{
+  const double median = median_of(samples);
+  const double limit = 3 * 1.4826 * mad_of(samples, median);
+  const auto n = samples.size();
+  if (limit > 0) {
+    samples.erase(std::remove_if(samples.begin(), samples.end(),
+                                 [&](double x) {
+                                   return (x > median ? x - median : median - x) > limit;
+                                 }),
+                  samples.end());
+  }
+  const double m = median_of(samples);
+  return {m, mad_of(samples, m), n - samples.size()};
+}
+
+// mann_whitney_p {{{1
+/**\internal
+ * One-sided Mann-Whitney U test (normal approximation with tie and continuity correction).
+ * Returns the p-value for the hypothesis that values from \p a tend to be larger than
+ * values from \p b.
+ */
+inline double mann_whitney_p(const std::vector<double> &a, const std::vector<double> &b)
+{
+  const std::size_t n1 = a.size(), n2 = b.size(), n = n1 + n2;
+  if (n1 == 0 || n2 == 0) {
+    return 1;
+  }
+  std::vector<std::pair<double, bool>> all;  // value, is from a
+  all.reserve(n);
+  for (double x : a) {
+    all.emplace_back(x, true);
+  }
+  for (double x : b) {
+    all.emplace_back(x, false);
+  }
+  std::sort(all.begin(), all.end());
+  double rank_sum_a = 0;
+  double tie_term = 0;
+  for (std::size_t i = 0; i < n;) {
+    std::size_t j = i + 1;
+    while (j < n && all[j].first == all[i].first) {
+      ++j;
+    }
+    const double ties = j - i;
+    const double rank = (i + 1 + j) / 2.;  // average of ranks i + 1, ..., j
+    for (std::size_t k = i; k < j; ++k) {
+      rank_sum_a += all[k].second ? rank : 0;
+    }
+    tie_term += ties * ties * ties - ties;
+    i = j;
+  }
+  const double u = rank_sum_a - n1 * (n1 + 1) / 2.;
+  const double mean = n1 * n2 / 2.;
+  const double sigma = std::sqrt(n1 * n2 / 12. * ((n + 1) - tie_term / (n * (n - 1.))));
+  if (sigma == 0) {
+    return u > mean ? 0 : 1;
+  }
+  const double z = (u - mean - 0.5) / sigma;
+  return 0.5 * std::erfc(z / std::sqrt(2.));
+}
+
+// benchmark_result {{{1
+struct benchmark_result {
+  std::string name;
+  std::string key;  // name, plus /<size> and #<n> for the n-th measurement of a benchmark
+  std::vector<double> samples;  // seconds per iteration, outliers removed
+  sample_stats stats;           // of samples
+  std::uint64_t iterations;     // per sample
+  double items;                 // processed per iteration
+  double bytes;                 // processed per iteration
+  std::size_t size;             // problem size, 0 if not set
+  vir::detail::perf_counters::values counters;  // of all samples, if --perf-counters
+};
+
+// a deque, because measure() returns references to its elements
+inline std::deque<benchmark_result> &benchmark_results()
+{
+  static std::deque<benchmark_result> results;
+  return results;
+}
+
+struct benchmark_settings {
+  double items_per_iteration = 0;
+  double bytes_per_iteration = 0;
+  std::size_t problem_size = 0;
+  std::size_t samples = 25;
+  double sample_time = 1e-3;  // seconds
+  double warmup_time = 10e-3;
+};
+
+inline benchmark_settings &benchmark_config()
+{
+  static benchmark_settings settings;
+  return settings;
+}
+
+// print helpers {{{1
+inline std::string si_format(double x, const char *unit)
+{
+  static const char prefixes[] = " kMGTPE";
+  int p = 0;
+  while (x >= 1000 && p < 6) {
+    x /= 1000;
+    ++p;
+  }
+  std::ostringstream s;
+  s << std::setprecision(3) << x << ' ';
+  if (p > 0) {
+    s << prefixes[p];
+  }
+  s << unit;
+  return s.str();
+}
+
+inline std::string time_format(double seconds)
+{
+  static const char *const units[] = {"s", "ms", "µs", "ns", "ps"};
+  int u = 0;
+  while (seconds < 1 && u < 4) {
+    seconds *= 1000;
+    ++u;
+  }
+  std::ostringstream s;
+  s << std::setprecision(4) << seconds << ' ' << units[u];
+  return s.str();
+}
+
+// run_batch {{{1
+template <class F>
+VIR_ALWAYS_INLINE std::uint64_t run_batch(F &f, std::uint64_t n, std::true_type)
+{
+  const std::uint64_t t0 = tsc();
+  for (std::uint64_t i = 0; i < n; ++i) {
+    f();
+  }
+  return tsc() - t0;
+}
+
+template <class F>
+VIR_ALWAYS_INLINE std::uint64_t run_batch(F &f, std::uint64_t n, std::false_type)
+{
+  const std::uint64_t t0 = tsc();
+  for (std::uint64_t i = 0; i < n; ++i) {
+    keep_result(f());
+  }
+  return tsc() - t0;
+}
+
+// report {{{1
+/**\internal
+ * Splits "name<type>" into "name" and "type" (without the padding of typeToString).
+ */
+inline std::pair<std::string, std::string> split_benchmark_name(const std::string &name)
+{
+  const auto open = name.find('<');
+  if (open == std::string::npos || name.back() != '>') {
+    return {name, std::string()};
+  }
+  const auto first = name.find_first_not_of(' ', open + 1);
+  return {name.substr(0, open), name.substr(first, name.size() - first - 1)};
+}
+
+inline std::size_t display_width(const std::string &s)
+{
+  return std::count_if(s.begin(), s.end(), [](char c) { return (c & 0xc0) != 0x80; });
+}
+
+inline std::string pad(const std::string &s, std::size_t width)
+{
+  const auto w = display_width(s);
+  return w >= width ? s : std::string(width - w, ' ') + s;
+}
+
+inline std::string csv_quote(const std::string &s)
+{
+  std::string r = "\"";
+  for (char c : s) {
+    r += c;
+    if (c == '"') {
+      r += c;
+    }
+  }
+  return r + '"';
+}
+
+/**\internal
+ * Entry of the benchmark report: the first measurement of every benchmark/type/size.
+ */
+struct report_entry {
+  std::string type;
+  const benchmark_result *result;
+  double speedup;  // relative to the reference type, 0 if there is none
+};
+
+/**\internal
+ * Prints one table per benchmark with more than one type or problem size: types as rows,
+ * problem sizes as columns, throughput (or time per iteration) and speedup relative to
+ * the reference type (--bench-reference, default: the first type) as cells. With
+ * --bench-csv all measurements are written as CSV.
+ */
+inline void report_benchmarks()
+{
+  using group_type = std::pair<std::string, std::vector<report_entry>>;
+  std::vector<group_type> groups;
+  for (const auto &r : benchmark_results()) {
+    const auto name = split_benchmark_name(r.name);
+    auto group = std::find_if(groups.begin(), groups.end(),
+                              [&](const group_type &g) { return g.first == name.first; });
+    if (group == groups.end()) {
+      groups.emplace_back(name.first, std::vector<report_entry>());
+      group = groups.end() - 1;
+    }
+    auto &entries = group->second;
+    if (std::none_of(entries.begin(), entries.end(), [&](const report_entry &e) {
+          return e.type == name.second && e.result->size == r.size;
+        })) {
+      entries.push_back({name.second, &r, 0.});
+    }
+  }
+
+  std::ofstream csv;
+  if (global_unit_test_object_.bench_csv) {
+    csv.open(global_unit_test_object_.bench_csv);
+    csv << "benchmark,type,size,median_s,mad_s,items_per_s,bytes_per_s,speedup\n"
+        << std::setprecision(6);
+  }
+  for (auto &group : groups) {
+    auto &entries = group.second;
+    std::vector<std::string> types;
+    std::vector<std::size_t> sizes;
+    for (const auto &e : entries) {
+      if (std::find(types.begin(), types.end(), e.type) == types.end()) {
+        types.push_back(e.type);
+      }
+      if (std::find(sizes.begin(), sizes.end(), e.result->size) == sizes.end()) {
+        sizes.push_back(e.result->size);
+      }
+    }
+    std::string reference = types.front();
+    if (global_unit_test_object_.bench_reference &&
+        std::find(types.begin(), types.end(), global_unit_test_object_.bench_reference) !=
+            types.end()) {
+      reference = global_unit_test_object_.bench_reference;
+    }
+    if (types.size() > 1) {
+      for (auto &e : entries) {
+        for (const auto &ref : entries) {
+          if (ref.type == reference && ref.result->size == e.result->size) {
+            e.speedup = ref.result->stats.median / e.result->stats.median;
+          }
+        }
+      }
+    }
+
+    for (const auto &e : entries) {
+      if (csv.is_open()) {
+        const auto &r = *e.result;
+        csv << csv_quote(group.first) << ',' << csv_quote(e.type) << ',' << r.size << ','
+            << r.stats.median << ',' << r.stats.mad << ',';
+        if (r.items > 0) {
+          csv << r.items / r.stats.median;
+        }
+        csv << ',';
+        if (r.bytes > 0) {
+          csv << r.bytes / r.stats.median;
+        }
+        csv << ',';
+        if (e.speedup > 0) {
+          csv << e.speedup;
+        }
+        csv << '\n';
+      }
+    }
+
+    if (types.size() == 1 && sizes.size() == 1) {
+      continue;
+    }
+    // cells[row][column], row 0 and column 0 are the headers
+    std::vector<std::vector<std::string>> cells(types.size() + 1,
+                                                std::vector<std::string>(sizes.size() + 1));
+    cells[0][0] = "T \\ n";
+    for (std::size_t col = 0; col < sizes.size(); ++col) {
+      cells[0][col + 1] = sizes[col] > 0 ? std::to_string(sizes[col]) : "-";
+    }
+    for (std::size_t row = 0; row < types.size(); ++row) {
+      cells[row + 1][0] = types[row];
+    }
+    for (const auto &e : entries) {
+      const auto &r = *e.result;
+      const auto row = std::find(types.begin(), types.end(), e.type) - types.begin() + 1;
+      const auto col = std::find(sizes.begin(), sizes.end(), r.size) - sizes.begin() + 1;
+      std::ostringstream cell;
+      if (r.items > 0) {
+        cell << si_format(r.items / r.stats.median, "items/s");
+      } else if (r.bytes > 0) {
+        cell << si_format(r.bytes / r.stats.median, "B/s");
+      } else {
+        cell << time_format(r.stats.median);
+      }
+      if (e.speedup > 0) {
+        cell << std::fixed << std::setprecision(2) << " (" << e.speedup << "×)";
+      }
+      cells[row][col] = cell.str();
+    }
+    std::vector<std::size_t> widths(sizes.size() + 1);
+    for (const auto &row : cells) {
+      for (std::size_t col = 0; col < row.size(); ++col) {
+        widths[col] = std::max(widths[col], display_width(row[col]));
+      }
+    }
+    std::cout << " " << group.first;
+    if (types.size() > 1) {
+      std::cout << " (speedup relative to " << reference << ')';
+    }
+    std::cout << '\n';
+    for (const auto &row : cells) {
+      std::cout << "   " << row[0] << std::string(widths[0] - display_width(row[0]), ' ');
+      for (std::size_t col = 1; col < row.size(); ++col) {
+        std::cout << " │ " << pad(row[col], widths[col]);
+      }
+      std::cout << '\n';
+    }
+  }
+}
+
+// baseline files {{{1
+inline bool baseline_readable()
+{
+  static const bool readable =
+      static_cast<bool>(std::ifstream(global_unit_test_object_.bench_compare));
+  return readable;
+}
+
+inline const std::map<std::string, std::vector<double>> &baseline_samples()
+{
+  static const std::map<std::string, std::vector<double>> data = [] {
+    std::map<std::string, std::vector<double>> r;
+    std::ifstream file(global_unit_test_object_.bench_compare);
+    std::string line;
+    while (std::getline(file, line)) {
+      const auto tab = line.find('\t');
+      if (tab == std::string::npos) {
+        continue;
+      }
+      std::istringstream fields(line.substr(tab + 1));
+      double median, mad;
+      std::size_t n;
+      fields >> median >> mad >> n;
+      std::vector<double> &samples = r[line.substr(0, tab)];
+      samples.resize(n);
+      for (double &x : samples) {
+        fields >> x;
+      }
+    }
+    return r;
+  }();
+  return data;
+}
+
+/**\internal
+ * Fails the current benchmark because of \p path. Reported once per benchmark, not per
+ * measurement.
+ */
+inline void baseline_file_error(const benchmark_result &r, const char *message,
+                                const char *path)
+{
+  static std::set<std::string> reported;
+  if (reported.insert(message + r.name).second) {
+    std::cout << failString();
+    if (!global_unit_test_object_.vim_lines) {
+      std::cout << "┍ ";
+    }
+    std::cout << message << ' ' << path << '\n';
+  }
+  global_unit_test_object_.status = false;
+}
+
+/**\internal
+ * One line per measurement: key, median, MAD, number of samples, samples (seconds per
+ * iteration), separated by tabs.
+ */
+inline void write_baseline(const benchmark_result &r)
+{
+  if (global_unit_test_object_.bench_compare) {
+    // --bench-compare may name the same file: read it before it is truncated
+    baseline_readable();
+    baseline_samples();
+  }
+  static std::ofstream file(global_unit_test_object_.bench_baseline);
+  if (!file) {
+    baseline_file_error(r, "cannot write benchmark baseline",
+                        global_unit_test_object_.bench_baseline);
+    return;
+  }
+  file << r.key << std::setprecision(17) << '\t' << r.stats.median << '\t' << r.stats.mad
+       << '\t' << r.samples.size();
+  for (double x : r.samples) {
+    file << '\t' << x;
+  }
+  file << std::endl;
+}
+
+/**\internal
+ * Compares \p r against the baseline. A significant (p < 0.01) slowdown beyond
+ * --bench-threshold fails the benchmark, as does an unreadable baseline file.
+ */
+inline void compare_to_baseline(const benchmark_result &r, std::ostream &details)
+{
+  if (!baseline_readable()) {
+    baseline_file_error(r, "cannot read benchmark baseline",
+                        global_unit_test_object_.bench_compare);
+    return;
+  }
+  const auto &baseline = baseline_samples();
+  const auto it = baseline.find(r.key);
+  if (it == baseline.end()) {
+    details << ", no baseline";
+    return;
+  }
+  const double base_median = median_of(it->second);
+  const double change = r.stats.median / base_median - 1;
+  const double p_slower = mann_whitney_p(r.samples, it->second);
+  details << ", " << std::showpos << std::setprecision(3) << change * 100 << std::noshowpos
+          << "% vs. baseline (p = " << std::setprecision(2) << p_slower << ')';
+  if (p_slower < 0.01 && change > global_unit_test_object_.bench_threshold) {
+    std::cout << failString();
+    if (!global_unit_test_object_.vim_lines) {
+      std::cout << "┍ ";
+    }
+    std::cout << r.key << " is " << std::setprecision(3) << change * 100
+              << "% slower than the baseline (" << time_format(base_median) << " → "
+              << time_format(r.stats.median) << ", Mann-Whitney p = "
+              << std::setprecision(2) << p_slower << ")\n"
+              << std::setprecision(6);
+    global_unit_test_object_.status = false;
+  }
+}
+
+//}}}1
+}  // namespace detail
+
+// set_problem_size {{{1
+/**
+ * Labels the following measurements with the problem size \p n. The benchmark report
+ * prints a table with one column per problem size and one row per type of a
+ * BENCHMARK_TYPES benchmark.
+ */
+inline void set_problem_size(std::size_t n) { detail::benchmark_config().problem_size = n; }
+
+// set_items_per_iteration / set_bytes_per_iteration {{{1
+/**
+ * The number of items (bytes) one call of the function passed to measure() processes. If
+ * set, measure() reports the throughput in items/s (B/s).
+ */
+inline void set_items_per_iteration(double n)
+{
+  detail::benchmark_config().items_per_iteration = n;
+}
+inline void set_bytes_per_iteration(double n)
+{
+  detail::benchmark_config().bytes_per_iteration = n;
+}
+
+// measure {{{1
+/**
+ * Measures the run time of \p f. \p f is called repeatedly for a warm-up phase. Then the
+ * number of calls per sample is calibrated such that a sample takes at least 1 ms. Median
+ * and median absolute deviation (MAD) of the samples, after removing outliers, are
+ * appended to the PASS line of the benchmark.
+ *
+ * If \p f returns a value, the value is passed through do_not_optimize, so that the
+ * compiler cannot optimize the work away. Inputs should be passed through
+ * make_value_unknown (scalars) or make_range_unknown (buffers).
+ *
+ * The returned reference stays valid for the rest of the program.
+ */
+template <class F> const detail::benchmark_result &measure(F &&f)
+{
+  using is_void = std::is_void<decltype(f())>;
+  const auto &config = detail::benchmark_config();
+  const double tps = detail::ticks_per_second();
+
+  // warm-up & calibration
+  std::uint64_t n = 1;
+  std::uint64_t ticks = detail::run_batch(f, n, is_void());
+  const double warmup_ticks = config.warmup_time * tps;
+  const double sample_ticks = config.sample_time * tps;
+  for (double elapsed = ticks; elapsed < warmup_ticks || ticks < sample_ticks;) {
+    if (ticks < sample_ticks) {
+      n *= 2;
+    }
+    ticks = detail::run_batch(f, n, is_void());
+    elapsed += ticks;
+  }
+
+  detail::benchmark_result r;
+  r.name = detail::global_unit_test_object_.test_name;
+  r.size = config.problem_size;
+  r.key = r.name;
+  if (r.size > 0) {
+    r.key += '/' + std::to_string(r.size);
+  }
+  const auto previous = std::count_if(
+      detail::benchmark_results().begin(), detail::benchmark_results().end(),
+      [&](const detail::benchmark_result &x) { return x.name == r.name && x.size == r.size; });
+  if (previous > 0) {
+    r.key += '#' + std::to_string(previous);
+  }
+  r.iterations = n;
+  r.items = config.items_per_iteration;
+  r.bytes = config.bytes_per_iteration;
+  r.samples.reserve(config.samples);
+  const auto &counters = detail::global_unit_test_object_.perfCounters;
+  const auto counters_before = counters.read();
+  for (std::size_t i = 0; i < config.samples; ++i) {
+    r.samples.push_back(detail::run_batch(f, n, is_void()) / tps / n);
+  }
+  r.counters = vir::detail::perf_counters::difference(counters.read(), counters_before);
+  r.stats = detail::summarize(r.samples);
+
+  std::ostringstream s;
+  s << "\n    ";
+  if (r.size > 0) {
+    s << "n = " << r.size << ": ";
+  }
+  s << detail::time_format(r.stats.median) << " ± "
+    << detail::time_format(r.stats.mad) << " (median ± MAD of " << r.samples.size()
+    << " samples × " << n << " iterations";
+  if (r.stats.outliers > 0) {
+    s << ", " << r.stats.outliers << " outliers";
+  }
+  s << ')';
+#ifdef VIR_HAVE_TSC
+  s << ", " << std::setprecision(4) << r.stats.median * tps << " TSC ticks";
+#endif
+  if (r.items > 0) {
+    s << ", " << detail::si_format(r.items / r.stats.median, "items/s");
+  }
+  if (r.bytes > 0) {
+    s << ", " << detail::si_format(r.bytes / r.stats.median, "B/s");
+  }
+  if (!r.counters.empty()) {
+    s << "\n    per iteration:";
+    const double total_iterations = double(n) * config.samples;
+    for (const auto &c : r.counters) {
+      s << ' ' << c.first << '=' << std::setprecision(4) << c.second / total_iterations;
+    }
+  }
+  if (detail::global_unit_test_object_.bench_baseline) {
+    detail::write_baseline(r);
+  }
+  if (detail::global_unit_test_object_.bench_compare) {
+    detail::compare_to_baseline(r, s);
+  }
+  detail::global_unit_test_object_.test_details += s.str();
+  detail::global_unit_test_object_.bench_report = &detail::report_benchmarks;
+  detail::benchmark_results().push_back(std::move(r));
+  return detail::benchmark_results().back();
+}
+
+namespace detail
+{
+// class Benchmark {{{1
+template <typename TestWrapper> struct Benchmark : public TestWrapper {
+  static void run()
+  {
+    benchmark_config().items_per_iteration = 0;
+    benchmark_config().bytes_per_iteration = 0;
+    benchmark_config().problem_size = 0;
+    TestWrapper::run();
+  }
+  Benchmark(std::string name) { allBenchmarks.emplace_back(&run, std::move(name)); }
+};
+
+template <template <typename> class TestWrapper> struct BenchmarkWrapper {
+  template <typename T> struct type {
+    static void run() { Benchmark<TestWrapper<T>>::run(); }
+  };
+};
+
+//}}}1
+}  // namespace detail
+}  // namespace test
+}  // namespace vir
+
+// BENCHMARK / BENCHMARK_TYPES macros {{{1
+#define BENCHMARK(name_)                                                                 \
+  namespace Tests                                                                        \
+  {                                                                                      \
+  struct name_##_ {                                                                      \
+    static void run();                                                                   \
+  };                                                                                     \
+  vir::test::detail::Benchmark<name_##_> benchmark_##name_##_(#name_);                   \
+  }                                                                                      \
+  void Tests::name_##_::run()
+
+#define BENCHMARK_TYPES(T_, name_, ...)                                                  \
+  namespace Tests                                                                        \
+  {                                                                                      \
+  template <typename T_> struct name_##_ {                                               \
+    static void run();                                                                   \
+  };                                                                                     \
+  static struct name_##_ctor {                                                           \
+    name_##_ctor()                                                                       \
+    {                                                                                    \
+      using vir::Typelist;                                                               \
+      using vir::concat;                                                                 \
+      using vir::outer_product;                                                          \
+      using list = vir::ensure_typelist_t<__VA_ARGS__>;                                  \
+      vir::test::detail::addTestInstantiations<                                          \
+          vir::test::detail::BenchmarkWrapper<name_##_>::template type>(                 \
+          #name_, list{}, vir::test::detail::allBenchmarks);                             \
+    }                                                                                    \
+  } name_##_ctor_;                                                                       \
+  }                                                                                      \
+  template <typename T_> void Tests::name_##_<T_>::run()
+
+//}}}1
+#endif  // VIR_BENCHMARK_H_
+// vim: foldmethod=marker
@@ -0,0 +1,217 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#ifndef VIR_DETAIL_CHECK_HITS_H_
+#define VIR_DETAIL_CHECK_HITS_H_
+
+#ifdef VIR_TEST_CHECK_HITS
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined __ELF__ && defined __GNUC__
+// The site records are placed in one section so that the linker collects them, including
+// the ones of checks that never execute.
+#define VIR_CHECK_SITES_IN_SECTION 1
+#define VIR_CHECK_SITE_ATTRIBUTE_ __attribute__((__section__("vir_check_sites"), __used__))
+#else
+#define VIR_CHECK_SITE_ATTRIBUTE_
+#endif
+
+namespace vir
+{
+namespace detail
+{
+// check_site {{{1
+/**\internal
+ * The record every check macro expansion owns if VIR_TEST_CHECK_HITS is defined. It is
+ * constant-initialized, so counting a hit is a single relaxed atomic increment.
+ */
+struct check_site {
+  const char *file;
+  int line;
+  const char *expression;
+  std::atomic<std::uint64_t> hits;
+};
+
+inline void count_check_hit(check_site &site)
+{
+  site.hits.fetch_add(1, std::memory_order_relaxed);
+}
+
+// register_check_site {{{1
+/**\internal
+ * Sites also register during static initialization: GCC ignores the section attribute on
+ * static locals of template instantiations, and other targets have no section to collect.
+ */
+inline std::vector<const check_site *> &check_site_registry(std::mutex *&lock)
+{
+  static std::mutex m;
+  static std::vector<const check_site *> sites;
+  lock = &m;
+  return sites;
+}
+
+inline bool register_check_site(const check_site &site)
+{
+  std::mutex *m;
+  auto &sites = check_site_registry(m);
+  std::lock_guard<std::mutex> guard(*m);
+  sites.push_back(&site);
+  return true;
+}
+
+/**\internal
+ * Registers the site of \p Tag (a class local to the macro expansion) during static
+ * initialization, so that counting a hit does not test a guard variable.
+ */
+template <class Tag> struct check_site_registration {
+  static const bool registered;
+};
+template <class Tag>
+const bool check_site_registration<Tag>::registered = register_check_site(Tag::site());
+
+template <class Tag> inline check_site &registered_check_site()
+{
+  (void)check_site_registration<Tag>::registered;  // odr-use: instantiates the registration
+  return Tag::site();
+}
+
+#ifdef VIR_CHECK_SITES_IN_SECTION
+extern "C" {
+extern check_site __start_vir_check_sites[] __attribute__((__weak__, __visibility__("hidden")));
+extern check_site __stop_vir_check_sites[] __attribute__((__weak__, __visibility__("hidden")));
+}
+#endif
+
+// all_check_sites {{{1
+inline std::vector<const check_site *> all_check_sites()
+{
+  std::mutex *m;
+  auto &registered = check_site_registry(m);
+  std::vector<const check_site *> sites;
+  {
+    std::lock_guard<std::mutex> guard(*m);
+    sites = registered;
+  }
+#ifdef VIR_CHECK_SITES_IN_SECTION
+  for (const check_site *it = __start_vir_check_sites; it < __stop_vir_check_sites; ++it) {
+    sites.push_back(it);
+  }
+#endif
+  std::sort(sites.begin(), sites.end(), std::less<const check_site *>());
+  sites.erase(std::unique(sites.begin(), sites.end()), sites.end());
+  return sites;
+}
+
+// print_check_hits {{{1
+/**\internal
+ * Prints every check site sorted by descending hit count. Template instantiations of the
+ * same check are merged into one row.
+ */
+inline void print_check_hits(std::ostream &out)
+{
+  struct row {
+    const char *file;
+    int line;
+    const char *expression;
+    std::uint64_t hits;
+  };
+  std::vector<row> rows;
+  for (const check_site *site : all_check_sites()) {
+    const auto hits = site->hits.load(std::memory_order_relaxed);
+    auto it = std::find_if(rows.begin(), rows.end(), [&](const row &r) {
+      return r.line == site->line && std::strcmp(r.file, site->file) == 0 &&
+             std::strcmp(r.expression, site->expression) == 0;
+    });
+    if (it == rows.end()) {
+      rows.push_back({site->file, site->line, site->expression, hits});
+    } else {
+      it->hits += hits;
+    }
+  }
+  std::sort(rows.begin(), rows.end(), [](const row &a, const row &b) {
+    if (a.hits != b.hits) {
+      return a.hits > b.hits;
+    }
+    const int f = std::strcmp(a.file, b.file);
+    return f < 0 || (f == 0 && a.line < b.line);
+  });
+
+  const auto precision = out.precision();
+  std::uint64_t total = 0;
+  std::size_t dead = 0;
+  for (const row &r : rows) {
+    total += r.hits;
+    dead += r.hits == 0;
+  }
+  out << "\n Check hits: " << rows.size() << " sites, " << total << " checks, " << dead
+      << " never executed\n";
+  out << std::setw(14) << "hits" << std::setw(8) << "share" << "  location: expression\n";
+  for (const row &r : rows) {
+    std::string expression = r.expression;
+    if (expression.size() > 60) {
+      expression = expression.substr(0, 57) + "...";
+    }
+    out << std::setw(14) << r.hits << std::setw(7) << std::fixed << std::setprecision(1)
+        << (total == 0 ? 0. : 100. * r.hits / total) << "%  " << r.file << ':' << r.line
+        << ": " << expression << '\n';
+  }
+  out << std::defaultfloat << std::setprecision(precision);
+}
+
+//}}}1
+}  // namespace detail
+}  // namespace vir
+
+// VIR_CHECK_HIT_ {{{1
+#define VIR_CHECK_HIT_(expression_)                                                      \
+  vir::detail::count_check_hit([]() -> vir::detail::check_site & {                       \
+    struct tag_ {                                                                        \
+      static vir::detail::check_site &site()                                             \
+      {                                                                                  \
+        VIR_CHECK_SITE_ATTRIBUTE_ static vir::detail::check_site site_ = {               \
+            __FILE__, __LINE__, expression_, {0}};                                       \
+        return site_;                                                                    \
+      }                                                                                  \
+    };                                                                                   \
+    return vir::detail::registered_check_site<tag_>();                                   \
+  }()),
+
+#else  // VIR_TEST_CHECK_HITS
+#define VIR_CHECK_HIT_(expression_)
+#endif  // VIR_TEST_CHECK_HITS
+
+#endif  // VIR_DETAIL_CHECK_HITS_H_
+// vim: foldmethod=marker
@@ -0,0 +1,133 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#ifndef VIR_DETAIL_DENORMALS_H_
+#define VIR_DETAIL_DENORMALS_H_
+
+#if defined __SSE__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 1)
+#define VIR_HAVE_DENORMAL_MODES 1
+#define VIR_DENORMALS_MXCSR 1
+#include <xmmintrin.h>
+#elif defined __aarch64__ && defined __GNUC__
+#define VIR_HAVE_DENORMAL_MODES 1
+#define VIR_DENORMALS_FPCR 1
+#endif
+
+namespace vir
+{
+namespace detail
+{
+// denormal_mode {{{1
+/**\internal
+ * How the FPU of the calling thread treats denormals: FTZ flushes denormal results to
+ * zero, DAZ reads denormal inputs as zero. x86 controls both via MXCSR. AArch64 has only
+ * FPCR.FZ, which does both, so there only ieee and ftz_daz are supported.
+ */
+enum class denormal_mode : unsigned { ieee = 0, ftz = 1, daz = 2, ftz_daz = 3 };
+
+inline const char *denormal_mode_name(denormal_mode mode)
+{
+  return mode == denormal_mode::ieee  ? "IEEE"
+         : mode == denormal_mode::ftz ? "FTZ"
+         : mode == denormal_mode::daz ? "DAZ"
+                                      : "FTZ+DAZ";
+}
+
+inline bool denormal_mode_supported(denormal_mode mode)
+{
+#if defined VIR_DENORMALS_MXCSR
+  static_cast<void>(mode);
+  return true;
+#elif defined VIR_DENORMALS_FPCR
+  return mode == denormal_mode::ieee || mode == denormal_mode::ftz_daz;
+#else
+  return mode == denormal_mode::ieee;
+#endif
+}
+
+// get_denormal_mode / set_denormal_mode {{{1
+inline denormal_mode get_denormal_mode()
+{
+#if defined VIR_DENORMALS_MXCSR
+  const unsigned csr = _mm_getcsr();
+  return static_cast<denormal_mode>(((csr >> 15) & 1u) | ((csr >> 5) & 2u));
+#elif defined VIR_DENORMALS_FPCR
+  unsigned long fpcr;
+  asm volatile("mrs %0, fpcr" : "=r"(fpcr));
+  return (fpcr >> 24) & 1u ? denormal_mode::ftz_daz : denormal_mode::ieee;
+#else
+  return denormal_mode::ieee;
+#endif
+}
+
+inline void set_denormal_mode(denormal_mode mode)
+{
+  const unsigned bits = static_cast<unsigned>(mode);
+#if defined VIR_DENORMALS_MXCSR
+  // FTZ is bit 15, DAZ is bit 6
+  _mm_setcsr((_mm_getcsr() & ~0x8040u) | ((bits & 1u) << 15) | ((bits & 2u) << 5));
+#elif defined VIR_DENORMALS_FPCR
+  unsigned long fpcr;
+  asm volatile("mrs %0, fpcr" : "=r"(fpcr));
+  fpcr = bits == 0 ? fpcr & ~(1ul << 24) : fpcr | (1ul << 24);
+  asm volatile("msr fpcr, %0" : : "r"(fpcr));
+#else
+  static_cast<void>(bits);
+#endif
+}
+
+// denormal_mode_guard {{{1
+/**\internal
+ * Switches the calling thread to \p mode and restores the previous mode on destruction.
+ */
+class denormal_mode_guard
+{
+  const denormal_mode m_saved;
+
+public:
+  explicit denormal_mode_guard(denormal_mode mode) : m_saved(get_denormal_mode())
+  {
+    if (mode != m_saved) {
+      set_denormal_mode(mode);
+    }
+  }
+  denormal_mode previous() const { return m_saved; }
+  denormal_mode_guard(const denormal_mode_guard &) = delete;
+  denormal_mode_guard &operator=(const denormal_mode_guard &) = delete;
+  ~denormal_mode_guard()
+  {
+    if (get_denormal_mode() != m_saved) {
+      set_denormal_mode(m_saved);
+    }
+  }
+};
+//}}}1
+}  // namespace detail
+}  // namespace vir
+
+#endif  // VIR_DETAIL_DENORMALS_H_
+// vim: foldmethod=marker
@@ -0,0 +1,137 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+
+#ifndef VIR_DETAIL_ISA_LEVEL_H_
+#define VIR_DETAIL_ISA_LEVEL_H_
+
+#include <cstring>
+
+#if defined __x86_64__ || defined _M_X64
+#if defined _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace vir
+{
+namespace detail
+{
+// parse_isa_level {{{1
+/**\internal
+ * Returns the x86-64 micro-architecture level (1-4) of the -march name \p name
+ * ("x86-64", "x86-64-v2", "x86-64-v3", "x86-64-v4") or 0 if \p name is none of these.
+ */
+inline int parse_isa_level(const char *name)
+{
+  if (0 == std::strcmp(name, "x86-64") || 0 == std::strcmp(name, "x86-64-v1")) {
+    return 1;
+  } else if (0 == std::strncmp(name, "x86-64-v", 8) && name[8] >= '2' && name[8] <= '4' &&
+             name[9] == '\0') {
+    return name[8] - '0';
+  }
+  return 0;
+}
+
+// host_isa_level {{{1
+#if defined __x86_64__ || defined _M_X64
+inline void cpuid(unsigned leaf, unsigned subleaf, unsigned (&regs)[4])
+{
+#ifdef _MSC_VER
+  int r[4];
+  __cpuidex(r, int(leaf), int(subleaf));
+  for (int i = 0; i < 4; ++i) {
+    regs[i] = unsigned(r[i]);
+  }
+#else
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+inline unsigned long long xgetbv0()
+{
+#ifdef _MSC_VER
+  return _xgetbv(0);
+#else
+  unsigned lo, hi;
+  asm("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+  return (static_cast<unsigned long long>(hi) << 32) | lo;
+#endif
+}
+#endif
+
+/**\internal
+ * Returns the highest x86-64 level (1-4) the CPU and OS support, or 0 on other
+ * architectures. Checks the feature sets of the x86-64 psABI levels via CPUID and XGETBV
+ * (the OS must save the AVX and AVX-512 registers).
+ */
+inline int host_isa_level()
+{
+#if defined __x86_64__ || defined _M_X64
+  const auto all = [](unsigned reg, unsigned mask) { return (reg & mask) == mask; };
+  unsigned leaf0[4], leaf1[4], leaf7[4] = {}, ext[4] = {};
+  cpuid(0, 0, leaf0);
+  cpuid(1, 0, leaf1);
+  if (leaf0[0] >= 7) {
+    cpuid(7, 0, leaf7);
+  }
+  cpuid(0x80000000u, 0, ext);
+  const bool has_ext1 = ext[0] >= 0x80000001u;
+  if (has_ext1) {
+    cpuid(0x80000001u, 0, ext);
+  }
+  // v2: SSE3, SSSE3, CX16, SSE4.1, SSE4.2, POPCNT (leaf 1 ecx), LAHF (ext ecx)
+  if (!all(leaf1[2], 1u | 1u << 9 | 1u << 13 | 1u << 19 | 1u << 20 | 1u << 23) ||
+      !has_ext1 || !all(ext[2], 1u)) {
+    return 1;
+  }
+  // v3: FMA, MOVBE, OSXSAVE, AVX, F16C (leaf 1 ecx), BMI1, AVX2, BMI2 (leaf 7 ebx),
+  // LZCNT (ext ecx), and the OS saves XMM/YMM state
+  if (!all(leaf1[2], 1u << 12 | 1u << 22 | 1u << 27 | 1u << 28 | 1u << 29) ||
+      !all(leaf7[1], 1u << 3 | 1u << 5 | 1u << 8) || !all(ext[2], 1u << 5) ||
+      (xgetbv0() & 0x6) != 0x6) {
+    return 2;
+  }
+  // v4: AVX512F, AVX512DQ, AVX512CD, AVX512BW, AVX512VL (leaf 7 ebx), and the OS saves
+  // opmask and ZMM state
+  if (!all(leaf7[1], 1u << 16 | 1u << 17 | 1u << 28 | 1u << 30 | 1u << 31) ||
+      (xgetbv0() & 0xe6) != 0xe6) {
+    return 3;
+  }
+  return 4;
+#else
+  return 0;
+#endif
+}
+//}}}1
+}  // namespace detail
+}  // namespace vir
+
+#endif  // VIR_DETAIL_ISA_LEVEL_H_
+// vim: foldmethod=marker
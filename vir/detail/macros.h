@@ -31,6 +31,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifdef __GNUC__
 #define VIR_ALWAYS_INLINE inline __attribute__((__always_inline__))
 #define VIR_NEVER_INLINE [[gnu::noinline]]
+#define VIR_COLD __attribute__((__noinline__, __cold__))
 #define VIR_CONST __attribute__((const))
 #define VIR_IS_UNLIKELY(x) __builtin_expect(x, 0)
 # ifdef __INTEL_COMPILER_BUILD_DATE
@@ -41,12 +42,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #elif defined _MSC_VER
 #define VIR_ALWAYS_INLINE inline __forceinline
 #define VIR_NEVER_INLINE
+#define VIR_COLD __declspec(noinline)
 #define VIR_CONST __declspec(noalias)
 #define VIR_IS_UNLIKELY(x) x
 #define VIR_DEPRECATED(msg) __declspec(deprecated(msg))
 #else
 #define VIR_ALWAYS_INLINE inline
 #define VIR_NEVER_INLINE
+#define VIR_COLD
 #define VIR_CONST
 #define VIR_IS_UNLIKELY(x) x
 #define VIR_DEPRECATED(msg) [[deprecated(msg)]]
@@ -0,0 +1,140 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#ifndef VIR_DETAIL_MISMATCH_H_
+#define VIR_DETAIL_MISMATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined __AVX2__ || defined __SSE2__
+#include <immintrin.h>
+#endif
+
+namespace vir
+{
+namespace detail
+{
+// trailing_zeros / popcount {{{1
+inline int trailing_zeros(std::uint32_t x)
+{
+#ifdef __GNUC__
+  return __builtin_ctz(x);
+#else
+  int n = 0;
+  for (; (x & 1) == 0; x >>= 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+
+inline int popcount(std::uint32_t x)
+{
+#ifdef __GNUC__
+  return __builtin_popcount(x);
+#else
+  int n = 0;
+  for (; x != 0; x &= x - 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+
+// first_mismatch {{{1
+/**\internal
+ * Returns the offset of the first byte in [\p from, \p size) where \p a and \p b differ, or
+ * \p size if they are equal. Compares 32 (AVX2) or 16 (SSE2) bytes per iteration.
+ */
+inline std::size_t first_mismatch(const unsigned char *a, const unsigned char *b,
+                                  std::size_t size, std::size_t from = 0)
+{
+  std::size_t i = from;
+#ifdef __AVX2__
+  for (; i + 32 <= size; i += 32) {
+    const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+    const std::uint32_t equal = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+    if (equal != 0xffffffffu) {
+      return i + trailing_zeros(~equal);
+    }
+  }
+#endif
+#ifdef __SSE2__
+  for (; i + 16 <= size; i += 16) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    const std::uint32_t equal = _mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+    if (equal != 0xffffu) {
+      return i + trailing_zeros(~equal);
+    }
+  }
+#endif
+  for (; i < size; ++i) {
+    if (a[i] != b[i]) {
+      return i;
+    }
+  }
+  return size;
+}
+
+// count_mismatches {{{1
+/**\internal
+ * Returns the number of bytes in [0, \p size) where \p a and \p b differ.
+ */
+inline std::size_t count_mismatches(const unsigned char *a, const unsigned char *b,
+                                    std::size_t size)
+{
+  std::size_t count = 0;
+  std::size_t i = 0;
+#ifdef __AVX2__
+  for (; i + 32 <= size; i += 32) {
+    const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+    count += 32 - popcount(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+  }
+#endif
+#ifdef __SSE2__
+  for (; i + 16 <= size; i += 16) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    count += 16 - popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+  }
+#endif
+  for (; i < size; ++i) {
+    count += a[i] != b[i];
+  }
+  return count;
+}
+
+//}}}1
+}  // namespace detail
+}  // namespace vir
+
+#endif  // VIR_DETAIL_MISMATCH_H_
+// vim: foldmethod=marker
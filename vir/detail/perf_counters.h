@@ -0,0 +1,248 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#ifndef VIR_DETAIL_PERF_COUNTERS_H_
+#define VIR_DETAIL_PERF_COUNTERS_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined VIR_HAVE_PERF_EVENTS && defined __linux__
+#define VIR_HAVE_PERF_EVENTS 1
+#endif
+#ifndef VIR_TEST_DECLARATIONS_ONLY
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#endif
+#if VIR_HAVE_PERF_EVENTS && !defined VIR_TEST_DECLARATIONS_ONLY
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace vir
+{
+namespace detail
+{
+// perf_counters {{{1
+/**\internal
+ * A group of hardware performance counters (Linux perf_event_open) for the calling thread,
+ * counting user space only. If the counters cannot be opened (e.g. because of
+ * /proc/sys/kernel/perf_event_paranoid or missing PMU access in a VM) a notice is printed
+ * and all member functions turn into no-ops.
+ *
+ * If the kernel multiplexes the counters (more events than the PMU has counters, or other
+ * perf users), every count is scaled by time_enabled / time_running and
+ * running_fraction() returns the fraction of the time the counters actually ran.
+ */
+class perf_counters
+{
+public:
+  using values = std::vector<std::pair<std::string, std::uint64_t>>;
+
+  perf_counters() = default;
+  perf_counters(const perf_counters &) = delete;
+  perf_counters &operator=(const perf_counters &) = delete;
+  ~perf_counters() { close(); }
+
+  // opens the counters in the comma-separated list \p names
+  bool open(const char *names);
+  // opens the same counters again, for the calling process (e.g. after fork)
+  void reopen();
+  bool active() const { return !m_fds.empty(); }
+  void start();
+  void stop();
+  // the current counts (also while counting), scaled if multiplexed
+  values read() const;
+  // time_running / time_enabled of the last read(); below 1 if the counts are estimates
+  double running_fraction() const { return m_running_fraction; }
+
+  static values difference(const values &after, const values &before)
+  {
+    values r = after;
+    for (std::size_t i = 0; i < r.size() && i < before.size(); ++i) {
+      // multiplexed counts are scaled estimates and need not be monotonic
+      r[i].second = after[i].second > before[i].second ? after[i].second - before[i].second
+                                                       : 0;
+    }
+    return r;
+  }
+
+private:
+  void close();
+
+  std::vector<int> m_fds;
+  std::vector<std::string> m_names;
+  mutable double m_running_fraction = 1.;
+};
+
+#ifndef VIR_TEST_DECLARATIONS_ONLY  // in library mode compiled into libvirtest only
+#if VIR_HAVE_PERF_EVENTS
+bool perf_counters::open(const char *names)
+{
+  struct event {
+    const char *name;
+    std::uint64_t config;
+  };
+  static const event known[] = {{"cycles", PERF_COUNT_HW_CPU_CYCLES},
+                                {"instructions", PERF_COUNT_HW_INSTRUCTIONS},
+                                {"cache-references", PERF_COUNT_HW_CACHE_REFERENCES},
+                                {"cache-misses", PERF_COUNT_HW_CACHE_MISSES},
+                                {"branches", PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+                                {"branch-misses", PERF_COUNT_HW_BRANCH_MISSES},
+                                {"ref-cycles", PERF_COUNT_HW_REF_CPU_CYCLES}};
+  close();
+  std::string list = names;
+  for (std::size_t begin = 0; begin < list.size();) {
+    std::size_t end = list.find(',', begin);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    const std::string name = list.substr(begin, end - begin);
+    begin = end + 1;
+    const event *e = nullptr;
+    for (const auto &k : known) {
+      if (name == k.name) {
+        e = &k;
+      }
+    }
+    if (!e) {
+      std::cout << "perf counters: unknown counter '" << name << "' ignored\n";
+      continue;
+    }
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = e->config;
+    attr.disabled = m_fds.empty() ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    const int fd = static_cast<int>(
+        syscall(SYS_perf_event_open, &attr, 0, -1, m_fds.empty() ? -1 : m_fds[0], 0));
+    if (fd < 0) {
+      const int err = errno;
+      int paranoid = -1;
+      std::ifstream("/proc/sys/kernel/perf_event_paranoid") >> paranoid;
+      std::cout << "perf counters unavailable: opening '" << name
+                << "' failed: " << std::strerror(err)
+                << " (perf_event_paranoid = " << paranoid << "). Continuing without.\n";
+      close();
+      return false;
+    }
+    m_fds.push_back(fd);
+    m_names.push_back(name);
+  }
+  return active();
+}
+
+void perf_counters::reopen()
+{
+  if (active()) {
+    std::string names;
+    for (const auto &name : m_names) {
+      names += (names.empty() ? "" : ",") + name;
+    }
+    open(names.c_str());
+  }
+}
+
+void perf_counters::start()
+{
+  if (active()) {
+    ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+void perf_counters::stop()
+{
+  if (active()) {
+    ioctl(m_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+perf_counters::values perf_counters::read() const
+{
+  values r;
+  m_running_fraction = 1.;
+  if (active()) {
+    // nr, time_enabled, time_running, values...
+    std::vector<std::uint64_t> buf(m_fds.size() + 3);
+    if (::read(m_fds[0], buf.data(), buf.size() * sizeof(std::uint64_t)) > 0) {
+      const std::uint64_t enabled = buf[1];
+      const std::uint64_t running = buf[2];
+      if (running < enabled) {
+        m_running_fraction = static_cast<double>(running) / static_cast<double>(enabled);
+      }
+      for (std::size_t i = 0; i < m_names.size() && i < buf[0]; ++i) {
+        std::uint64_t count = buf[i + 3];
+        if (running < enabled) {
+          count = running == 0 ? 0 : static_cast<std::uint64_t>(count / m_running_fraction);
+        }
+        r.emplace_back(m_names[i], count);
+      }
+    }
+  }
+  return r;
+}
+
+void perf_counters::close()
+{
+  for (auto it = m_fds.rbegin(); it != m_fds.rend(); ++it) {
+    ::close(*it);
+  }
+  m_fds.clear();
+  m_names.clear();
+}
+#else   // VIR_HAVE_PERF_EVENTS
+bool perf_counters::open(const char *)
+{
+  std::cout << "perf counters unavailable: only supported on Linux. Continuing without.\n";
+  return false;
+}
+void perf_counters::reopen() {}
+void perf_counters::start() {}
+void perf_counters::stop() {}
+perf_counters::values perf_counters::read() const { return {}; }
+void perf_counters::close() {}
+#endif  // VIR_HAVE_PERF_EVENTS
+#endif  // VIR_TEST_DECLARATIONS_ONLY
+
+//}}}1
+}  // namespace detail
+}  // namespace vir
+
+#endif  // VIR_DETAIL_PERF_COUNTERS_H_
+// vim: foldmethod=marker
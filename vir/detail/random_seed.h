@@ -0,0 +1,85 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#ifndef VIR_DETAIL_RANDOM_SEED_H_
+#define VIR_DETAIL_RANDOM_SEED_H_
+
+#include <chrono>
+#include <cstdint>
+
+namespace vir
+{
+namespace detail
+{
+// random_state {{{
+/**\internal
+ * The run-time seed shared by the test runner (which sets and reports it) and the random
+ * generators in vir/generators.h (which consume it).
+ */
+struct random_state {
+  std::uint64_t seed;      // --seed <n> or derived from the clock
+  std::uint64_t test_key;  // hash of the current test's name
+  bool used;               // whether the current test drew from the seed
+};
+
+inline std::uint64_t clock_seed()
+{
+  return static_cast<std::uint64_t>(
+      std::chrono::high_resolution_clock::now().time_since_epoch().count());
+}
+
+inline random_state &global_random_state()
+{
+  static random_state state = {clock_seed() % 1000000007u, 0, false};
+  return state;
+}
+
+// FNV-1a: stable across platforms and standard libraries, unlike std::hash
+inline std::uint64_t hash_name(const char *name)
+{
+  std::uint64_t h = 0xcbf29ce484222325u;
+  for (; *name; ++name) {
+    h = (h ^ static_cast<unsigned char>(*name)) * 0x100000001b3u;
+  }
+  return h;
+}
+
+// SplitMix64 step, for shuffles that do not depend on the standard library
+inline std::uint64_t splitmix64(std::uint64_t &state)
+{
+  std::uint64_t z = (state += 0x9e3779b97f4a7c15u);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+  return z ^ (z >> 31);
+}
+
+// }}}
+}  // namespace detail
+}  // namespace vir
+
+#endif  // VIR_DETAIL_RANDOM_SEED_H_
+// vim: foldmethod=marker
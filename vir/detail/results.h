@@ -0,0 +1,97 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#ifndef VIR_DETAIL_RESULTS_H_
+#define VIR_DETAIL_RESULTS_H_
+
+#include <cstdlib>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+namespace vir
+{
+namespace detail
+{
+/**\internal
+ * The format of the --results file, which virtest-merge reads:
+ *
+ *     # virtest results 1
+ *     TEST <status> <seconds> <max ulp> <sum of ulp> <number of ulp samples> <name>
+ *     ...
+ *     END <passed> <failed> <skipped>
+ *
+ * Fields are tab-separated, status is PASS, FAIL, XFAIL, or SKIP. The END line is written
+ * by finalize(); a file without it belongs to a run that did not finish.
+ */
+constexpr const char *results_header = "# virtest results 1";
+
+// test_result {{{1
+struct test_result {
+  std::string status;
+  double seconds = 0;
+  double max_ulp = 0;
+  double sum_ulp = 0;
+  long ulp_count = 0;
+  std::string name;
+};
+
+inline void write_result(std::ostream &out, const test_result &r)
+{
+  out << "TEST\t" << r.status << '\t' << r.seconds << '\t' << r.max_ulp << '\t'
+      << r.sum_ulp << '\t' << r.ulp_count << '\t' << r.name << '\n';
+}
+
+/**\internal
+ * Parses a TEST line. Returns false for any other line.
+ */
+inline bool parse_result(const std::string &line, test_result &r)
+{
+  std::istringstream in(line);
+  std::string tag;
+  if (!std::getline(in, tag, '\t') || tag != "TEST") {
+    return false;
+  }
+  std::string seconds, max_ulp, sum_ulp, ulp_count;
+  if (!std::getline(in, r.status, '\t') || !std::getline(in, seconds, '\t') ||
+      !std::getline(in, max_ulp, '\t') || !std::getline(in, sum_ulp, '\t') ||
+      !std::getline(in, ulp_count, '\t') || !std::getline(in, r.name)) {
+    return false;
+  }
+  r.seconds = std::atof(seconds.c_str());
+  r.max_ulp = std::atof(max_ulp.c_str());
+  r.sum_ulp = std::atof(sum_ulp.c_str());
+  r.ulp_count = std::atol(ulp_count.c_str());
+  return true;
+}
+
+//}}}1
+}  // namespace detail
+}  // namespace vir
+
+#endif  // VIR_DETAIL_RESULTS_H_
+// vim: foldmethod=marker
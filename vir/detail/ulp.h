@@ -31,6 +31,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cmath>
 #include <limits>
 #include <cfenv>
+#include <type_traits>
+#include "denormals.h"
 
 namespace vir
 {
@@ -59,17 +61,25 @@ template <class T, class R = typename T::value_type> R value_type_impl(int);
 template <class T> T value_type_impl(float);
 template <class T> using value_type_t = decltype(value_type_impl<T>(int()));
 
+// fast path for scalars: equal values need neither the FP environment nor frexp/ldexp
+template <class T> inline bool scalar_equal(const T &a, const T &b, std::true_type)
+{
+  return a == b;
+}
+template <class T> inline bool scalar_equal(const T &, const T &, std::false_type)
+{
+  return false;
+}
+
 template <
     class T,
     class = typename std::enable_if<std::is_floating_point<value_type_t<T>>::value>::type>
 inline T ulpDiffToReference(const T &val_, const T &ref_)
 {
+  if (scalar_equal(val_, ref_, std::is_floating_point<T>())) {
+    return T();
+  }
   const int fp_exceptions = std::fetestexcept(FE_ALL_EXCEPT);
-  T val = val_;
-  T ref = ref_;
-
-  T diff = T();
-
   using std::abs;
   using std::fpclassify;
   using std::frexp;
@@ -79,6 +89,20 @@ inline T ulpDiffToReference(const T &val_, const T &ref_)
   using std::max;
   using limits = std::numeric_limits<value_type_t<T>>;
 
+  // With FTZ/DAZ enabled a denormal value stands for zero: flush the inputs, then compute
+  // the distance without flushing (a difference of normal numbers can be denormal).
+  const denormal_mode_guard ieee(denormal_mode::ieee);
+  T val = val_;
+  T ref = ref_;
+  if (ieee.previous() != denormal_mode::ieee) {
+    where(abs(val) < limits::min(), val) = T();
+    where(abs(ref) < limits::min(), ref) = T();
+  }
+  const T val_in = val;
+  const T ref_in = ref;
+
+  T diff = T();
+
   where(ref == 0, val) = abs(val);
   where(ref == 0, diff) = 1;
   where(ref == 0, ref) = limits::min();
@@ -95,7 +119,7 @@ inline T ulpDiffToReference(const T &val_, const T &ref_)
   // denormal correctly
   exp = max(exp, I(limits::min_exponent));
   diff += ldexp(abs(ref - val), limits::digits - exp);
-  where(val_ == ref_ || (isnan(val_) && isnan(ref_)), diff) = T();
+  where(val_in == ref_in || (isnan(val_) && isnan(ref_)), diff) = T();
   std::feclearexcept(FE_ALL_EXCEPT ^ fp_exceptions);
   return diff;
 }
@@ -0,0 +1,171 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#ifndef VIR_DETAIL_WATCHDOG_H_
+#define VIR_DETAIL_WATCHDOG_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if !defined VIR_HAVE_WATCHDOG && (defined __unix__ || defined __APPLE__)
+#define VIR_HAVE_WATCHDOG 1
+#endif
+#if VIR_HAVE_WATCHDOG
+#include <sys/types.h>
+#endif
+#if VIR_HAVE_WATCHDOG && !defined VIR_TEST_DECLARATIONS_ONLY
+#include <algorithm>
+#include <cerrno>
+#include <new>
+#include <thread>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace vir
+{
+namespace detail
+{
+// watchdog_state {{{1
+/**\internal
+ * Shared between the runner and the child process that runs the current test. The child
+ * sets the deadline (set_timeout) and the location of the last failed check, the runner
+ * reads both.
+ */
+struct watchdog_state {
+  std::atomic<std::int64_t> deadline;  // steady_clock ticks, 0: no deadline
+  std::atomic<double> seconds;
+  std::atomic<const char *> file;
+  std::atomic<int> line;
+};
+
+// watchdog {{{1
+/**\internal
+ * Runs a test in a child process and kills it once it exceeds its deadline. A hanging test
+ * cannot be interrupted safely in-process (it may hold locks or be inside the allocator),
+ * but its process can be killed, and the runner continues with the next test.
+ */
+class watchdog
+{
+public:
+  using clock = std::chrono::steady_clock;
+
+  // nullptr unless a test ran in a child process
+  static watchdog_state *shared() { return shared_state(); }
+
+  // called on the failure paths of the checks only
+  static void record_failed_check(const char *file, int line)
+  {
+    if (watchdog_state *s = shared_state()) {
+      s->file.store(file, std::memory_order_relaxed);
+      s->line.store(line, std::memory_order_relaxed);
+    }
+  }
+
+  // a deadline \p seconds from now, or none if \p seconds <= 0
+  static void set_deadline(double seconds)
+  {
+    if (watchdog_state *s = shared_state()) {
+      s->seconds.store(seconds);
+      s->deadline.store(
+          seconds > 0 ? (clock::now() + std::chrono::duration_cast<clock::duration>(
+                                            std::chrono::duration<double>(seconds)))
+                            .time_since_epoch()
+                            .count()
+                      : 0);
+    }
+  }
+
+#if VIR_HAVE_WATCHDOG
+  /**\internal
+   * Forks a child process with a deadline \p seconds from now. Returns 0 in the child, the
+   * pid of the child in the runner, and -1 if no child could be started.
+   */
+  static pid_t start(double seconds);
+
+  /**\internal
+   * Waits for \p child to exit and stores its wait status in \p status. Returns false if
+   * the child was killed because it missed its deadline.
+   */
+  static bool wait(pid_t child, int &status);
+#endif  // VIR_HAVE_WATCHDOG
+
+private:
+  static watchdog_state *&shared_state()
+  {
+    static watchdog_state *s = nullptr;
+    return s;
+  }
+};
+
+#if VIR_HAVE_WATCHDOG && !defined VIR_TEST_DECLARATIONS_ONLY
+inline pid_t watchdog::start(double seconds)
+{
+  if (!shared_state()) {
+    void *p = mmap(nullptr, sizeof(watchdog_state), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+      return -1;
+    }
+    shared_state() = ::new (p) watchdog_state();
+  }
+  record_failed_check(nullptr, 0);
+  set_deadline(seconds);
+  return fork();
+}
+
+inline bool watchdog::wait(pid_t child, int &status)
+{
+  std::chrono::microseconds pause(50);
+  for (;;) {
+    const pid_t r = waitpid(child, &status, WNOHANG);
+    if (r == child || (r < 0 && errno != EINTR)) {
+      return true;
+    }
+    const std::int64_t deadline = shared_state()->deadline.load();
+    if (deadline != 0 && clock::now().time_since_epoch().count() >= deadline) {
+      kill(child, SIGKILL);
+      while (waitpid(child, &status, 0) < 0 && errno == EINTR) {
+      }
+      return false;
+    }
+    // short tests are reaped quickly, long ones cost few wakeups
+    std::this_thread::sleep_for(pause);
+    pause = std::min(pause * 2, std::chrono::microseconds(10000));
+  }
+}
+#endif  // VIR_HAVE_WATCHDOG && !VIR_TEST_DECLARATIONS_ONLY
+
+//}}}1
+}  // namespace detail
+}  // namespace vir
+
+#endif  // VIR_DETAIL_WATCHDOG_H_
+// vim: foldmethod=marker
@@ -25,6 +25,15 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 }}}*/
 
+#ifndef VIR_GENERATORS_H_
+#define VIR_GENERATORS_H_
+
+#include "detail/random_seed.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <limits>
 #include <type_traits>
 
@@ -70,4 +79,240 @@ inline typename std::enable_if<std::is_integral<T>::value>::type iterateNumericR
   }
 }
 
+namespace vir
+{
+namespace test
+{
+// counter_rng {{{1
+/**
+ * A counter-based pseudo-random number generator (SplitMix64 output function).
+ *
+ * The n-th value of a stream is a pure function of the stream's key and n. Therefore any
+ * position can be computed directly (at()) and streams can be split into independent
+ * sub-streams (split()), e.g. one per thread or shard, without any shared state. Satisfies
+ * the UniformRandomBitGenerator requirements and thus works with the `<random>`
+ * distributions.
+ */
+class counter_rng
+{
+public:
+  using result_type = std::uint64_t;
+
+  explicit counter_rng(std::uint64_t seed, std::uint64_t stream = 0)
+      : m_key(mix(seed) ^ mix(stream + 0xd1b54a32d192ed03u)), m_counter(0)
+  {
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return ~result_type(); }
+
+  result_type operator()() { return at(m_counter++); }
+
+  // the n-th value of this stream, independent of the current position
+  result_type at(std::uint64_t n) const { return mix(m_key + (n + 1) * gamma); }
+
+  // an independent stream, identified by \p stream, derived from this stream's key
+  counter_rng split(std::uint64_t stream) const { return counter_rng(m_key, stream); }
+
+  void discard(std::uint64_t n) { m_counter += n; }
+  std::uint64_t key() const { return m_key; }
+  std::uint64_t counter() const { return m_counter; }
+
+private:
+  static constexpr std::uint64_t gamma = 0x9e3779b97f4a7c15u;
+  static std::uint64_t mix(std::uint64_t z)
+  {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+    return z ^ (z >> 31);
+  }
+
+  std::uint64_t m_key;
+  std::uint64_t m_counter;
+};
+
+// random_seed / test_rng {{{1
+/**
+ * The seed of this test run. It is set with `--seed <n>` or otherwise derived from the
+ * clock. If a test that used the seed fails, the runner prints the seed so that the run can
+ * be replayed.
+ */
+inline std::uint64_t random_seed()
+{
+  auto &state = vir::detail::global_random_state();
+  state.used = true;
+  return state.seed;
+}
+
+/**
+ * Returns a generator seeded from random_seed() and the name of the running test. Thus a
+ * test draws the same values when replayed with `--seed <n> --only <name>`, independent of
+ * which tests ran before it.
+ */
+inline counter_rng test_rng()
+{
+  return counter_rng(random_seed(), vir::detail::global_random_state().test_key);
+}
+
+namespace detail
+{
+// bit helpers {{{1
+template <class T> inline T bit_cast_from_rng(counter_rng &rng)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "");
+  unsigned char bytes[sizeof(T)];
+  for (std::size_t i = 0; i < sizeof(T); i += sizeof(std::uint64_t)) {
+    const std::uint64_t bits = rng();
+    std::memcpy(bytes + i, &bits,
+                sizeof(T) - i < sizeof(bits) ? sizeof(T) - i : sizeof(bits));
+  }
+  T r;
+  std::memcpy(&r, bytes, sizeof(T));
+  return r;
+}
+
+// a value in [1, 2) with uniformly distributed mantissa bits
+template <class T> inline T random_mantissa(counter_rng &rng)
+{
+  constexpr int digits = std::numeric_limits<T>::digits - 1;
+  T m = 0;
+  int done = 0;
+  while (done < digits) {
+    const int n = digits - done < 32 ? digits - done : 32;
+    m = std::ldexp(m, n) + T(rng() >> (64 - n));
+    done += n;
+  }
+  return T(1) + std::ldexp(m, -digits);
+}
+}  // namespace detail
+
+// uniform_bits {{{1
+/**
+ * Uniformly distributed object representations of \p T. For floating-point types this
+ * covers all exponents, including zeros, subnormals, infinities, and NaNs.
+ */
+template <class T> struct uniform_bits {
+  using result_type = T;
+  T operator()(counter_rng &rng) const { return detail::bit_cast_from_rng<T>(rng); }
+};
+
+// log_uniform {{{1
+/**
+ * Normalized floating-point values with the (binary) exponent uniformly distributed over
+ * [\p min_exponent, \p max_exponent] and uniformly distributed mantissa bits. With
+ * \p with_sign both signs are generated, otherwise the results are positive.
+ */
+template <class T> struct log_uniform {
+  static_assert(std::is_floating_point<T>::value, "");
+  using result_type = T;
+  using limits = std::numeric_limits<T>;
+
+  int min_exponent = limits::min_exponent - 1;
+  int max_exponent = limits::max_exponent - 1;
+  bool with_sign = true;
+
+  log_uniform() = default;
+  log_uniform(int min_exp, int max_exp, bool sign = true)
+      : min_exponent(min_exp), max_exponent(max_exp), with_sign(sign)
+  {
+  }
+
+  T operator()(counter_rng &rng) const
+  {
+    const std::uint64_t bits = rng();
+    const int range = max_exponent - min_exponent + 1;
+    const int e = min_exponent + int((bits >> 1) % std::uint64_t(range));
+    const T r = std::ldexp(detail::random_mantissa<T>(rng), e);
+    return with_sign && (bits & 1) ? -r : r;
+  }
+};
+
+// subnormal {{{1
+/**
+ * Uniformly distributed subnormal (denormal) values of both signs.
+ */
+template <class T> struct subnormal {
+  static_assert(std::is_floating_point<T>::value, "");
+  using result_type = T;
+
+  T operator()(counter_rng &rng) const
+  {
+    using limits = std::numeric_limits<T>;
+    const std::uint64_t bits = rng();
+    // number of denorm_min steps below min(), i.e. the mantissa of the subnormal
+    constexpr int mantissa_bits = limits::digits - 1 < 63 ? limits::digits - 1 : 63;
+    std::uint64_t m = (bits >> (64 - mantissa_bits));
+    if (m == 0) {
+      m = 1;
+    }
+    const T r = T(m) * limits::denorm_min();
+    return (bits & 1) ? -r : r;
+  }
+};
+
+// near_special {{{1
+/**
+ * Values at and up to \p max_ulp ulp around the values where floating-point code tends to
+ * break: ±0, ±min, ±denorm_min, ±max, ±1, ±epsilon, ±infinity, and NaN.
+ */
+template <class T> struct near_special {
+  static_assert(std::is_floating_point<T>::value, "");
+  using result_type = T;
+
+  int max_ulp = 4;
+
+  near_special() = default;
+  explicit near_special(int ulp) : max_ulp(ulp) {}
+
+  T operator()(counter_rng &rng) const
+  {
+    using limits = std::numeric_limits<T>;
+    const T specials[] = {T(0),          limits::min(),     limits::denorm_min(),
+                          limits::max(), T(1),              limits::epsilon(),
+                          limits::infinity(), limits::quiet_NaN()};
+    constexpr std::uint64_t n_specials = sizeof(specials) / sizeof(T);
+    const std::uint64_t bits = rng();
+    T r = specials[(bits >> 1) % n_specials];
+    const int steps = int((bits >> 32) % std::uint64_t(2 * max_ulp + 1)) - max_ulp;
+    for (int i = 0; i < steps; ++i) {
+      r = std::nextafter(r, limits::infinity());
+    }
+    for (int i = 0; i > steps; --i) {
+      r = std::nextafter(r, -limits::infinity());
+    }
+    return (bits & 1) ? -r : r;
+  }
+};
+
+// fill {{{1
+/**
+ * Assigns `dist(rng.split(first_index + i))` to the i-th element of [\p first, \p last).
+ *
+ * Every element is drawn from its own sub-stream. Therefore the values only depend on the
+ * generator and the element index, and shards of one array can be filled independently
+ * (pass the shard's offset as \p first_index) with the same result as filling it at once.
+ */
+template <class It, class Dist>
+inline void fill(It first, It last, const Dist &dist, const counter_rng &rng,
+                 std::uint64_t first_index = 0)
+{
+  for (; first != last; ++first, ++first_index) {
+    counter_rng element_rng = rng.split(first_index);
+    *first = dist(element_rng);
+  }
+}
+
+template <class Container, class Dist>
+inline void fill(Container &c, const Dist &dist, const counter_rng &rng)
+{
+  using std::begin;
+  using std::end;
+  fill(begin(c), end(c), dist, rng);
+}
+
+//}}}1
+}  // namespace test
+}  // namespace vir
+
+#endif  // VIR_GENERATORS_H_
 // vim: foldmethod=marker
@@ -0,0 +1,361 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#ifndef VIR_PROPERTY_H_
+#define VIR_PROPERTY_H_
+
+#include "test.h"
+#include "generators.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace vir
+{
+namespace test
+{
+// shrink_candidates {{{1
+/**
+ * Returns values that are "simpler" than \p x, simplest first. TEST_PROPERTY uses these to
+ * reduce a failing input to a minimal counterexample. A generator can override this by
+ * providing a `shrink(const result_type &)` member function.
+ */
+template <class T>
+inline typename std::enable_if<std::is_integral<T>::value, std::vector<T>>::type
+shrink_candidates(const T &x)
+{
+  std::vector<T> r;
+  if (x != 0) {
+    r.push_back(0);
+    if (x / 2 != 0) {
+      r.push_back(x / 2);
+    }
+    const T closer = x > 0 ? T(x - 1) : T(x + 1);
+    if (closer != 0 && closer != x / 2) {
+      r.push_back(closer);
+    }
+  }
+  return r;
+}
+
+template <class T>
+inline typename std::enable_if<std::is_floating_point<T>::value, std::vector<T>>::type
+shrink_candidates(const T &x)
+{
+  std::vector<T> r;
+  if (x == 0) {
+    return r;
+  }
+  r.push_back(0);
+  if (std::isnan(x)) {
+    r.push_back(1);
+    r.push_back(std::numeric_limits<T>::infinity());
+    return r;
+  }
+  if (std::isinf(x)) {
+    r.push_back(std::copysign(std::numeric_limits<T>::max(), x));
+    return r;
+  }
+  if (x < 0) {
+    r.push_back(-x);
+  }
+  const T t = std::trunc(x);
+  if (t != x && t != 0) {
+    r.push_back(t);
+  }
+  const T half = x / 2;
+  if (half != x && half != 0) {
+    r.push_back(half);
+  }
+  // fewer mantissa bits
+  int exp = 0;
+  const T m = std::frexp(x, &exp);
+  for (int bits = 1; bits < std::numeric_limits<T>::digits; bits *= 2) {
+    const T rounded = std::ldexp(std::trunc(std::ldexp(m, bits)), exp - bits);
+    if (rounded != x && rounded != t && rounded != 0) {
+      r.push_back(rounded);
+      break;
+    }
+  }
+  return r;
+}
+
+template <class T>
+inline typename std::enable_if<!std::is_arithmetic<T>::value, std::vector<T>>::type
+shrink_candidates(const T &)
+{
+  return {};
+}
+
+namespace detail
+{
+// index_list {{{1
+template <std::size_t... Is> struct index_list {
+};
+template <std::size_t N, std::size_t... Is>
+struct make_index_list : make_index_list<N - 1, N - 1, Is...> {
+};
+template <std::size_t... Is> struct make_index_list<0, Is...> {
+  using type = index_list<Is...>;
+};
+
+// shrink_with (prefer Gen::shrink) {{{1
+template <class Gen, class T>
+inline auto shrink_with(const Gen &gen, const T &x, int) -> decltype(gen.shrink(x))
+{
+  return gen.shrink(x);
+}
+template <class Gen, class T>
+inline std::vector<T> shrink_with(const Gen &, const T &x, float)
+{
+  return shrink_candidates(x);
+}
+
+// print_value {{{1
+template <class T, class = decltype(std::cout << std::declval<const T &>())>
+inline void print_value(const T &x, int)
+{
+  if (std::is_floating_point<T>::value) {
+    std::cout << std::setprecision(std::numeric_limits<T>::max_digits10) << x
+              << std::setprecision(6);
+  } else {
+    std::cout << x;
+  }
+}
+template <class T> inline void print_value(const T &, float) { std::cout << '?'; }
+
+// property_runner {{{1
+/**\internal
+ * Evaluates a property on generated inputs. The inputs of case i are drawn from
+ * `rng.split(i)`, so every case can be generated independently on any thread.
+ */
+template <class F, class... Gens> class property_runner
+{
+  using args_type = std::tuple<typename Gens::result_type...>;
+  using indexes = typename make_index_list<sizeof...(Gens)>::type;
+
+  F m_property;
+  std::tuple<Gens...> m_gens;
+  counter_rng m_rng;
+
+  template <std::size_t... Is> void call(const args_type &args, index_list<Is...>) const
+  {
+    m_property(std::get<Is>(args)...);
+  }
+
+  // shrink the K-th argument {{{2
+  template <std::size_t K>
+  bool shrink_arg(args_type &, std::integral_constant<std::size_t, K>,
+                  std::integral_constant<std::size_t, K>) const
+  {
+    return false;
+  }
+
+  template <std::size_t K, std::size_t N>
+  bool shrink_arg(args_type &args, std::integral_constant<std::size_t, K>,
+                  std::integral_constant<std::size_t, N> n) const
+  {
+    for (const auto &candidate :
+         shrink_with(std::get<K>(m_gens), std::get<K>(args), int())) {
+      args_type tmp = args;
+      std::get<K>(tmp) = candidate;
+      if (fails(tmp)) {
+        args = tmp;
+        return true;
+      }
+    }
+    return shrink_arg(args, std::integral_constant<std::size_t, K + 1>(), n);
+  }
+
+  // print_args {{{2
+  template <std::size_t... Is>
+  static void print_args(const args_type &args, index_list<Is...>)
+  {
+    std::cout << '(';
+    const char *sep = "";
+    const int unused[] = {
+        0, ((std::cout << sep), print_value(std::get<Is>(args), int()), sep = ", ", 0)...};
+    (void)unused;
+    std::cout << ')';
+  }
+
+  //}}}2
+public:
+  property_runner(F f, const Gens &... gens)
+      : m_property(f), m_gens(gens...), m_rng(test_rng())
+  {
+  }
+
+  args_type generate(std::size_t i) const { return generate(m_rng.split(i), indexes()); }
+
+  template <std::size_t... Is>
+  args_type generate(counter_rng rng, index_list<Is...>) const
+  {
+    // braced initialization guarantees left-to-right evaluation
+    return args_type{std::get<Is>(m_gens)(rng)...};
+  }
+
+  // whether the property fails for args, without printing anything
+  bool fails(const args_type &args) const
+  {
+    const bool was_quiet = quiet_checks();
+    quiet_checks() = true;
+    bool failed = false;
+    try {
+      call(args, indexes());
+    } catch (const SkippedTest &) {  // SKIP() discards the input
+    } catch (...) {
+      failed = true;
+    }
+    quiet_checks() = was_quiet;
+    return failed;
+  }
+
+  // the index of the first failing case in [0, n), or n if all pass
+  std::size_t find_first_failure(std::size_t n) const
+  {
+    std::atomic<std::size_t> next(0);
+    std::atomic<std::size_t> first_failure(n);
+    auto &&worker = [&]() {
+      for (std::size_t i = next++; i < first_failure.load(); i = next++) {
+        if (fails(generate(i))) {
+          std::size_t prev = first_failure.load();
+          while (i < prev && !first_failure.compare_exchange_weak(prev, i)) {
+          }
+        }
+      }
+    };
+    const unsigned n_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < n_threads; ++t) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &t : threads) {
+      t.join();
+    }
+    return first_failure;
+  }
+
+  // reduces failing args to a (locally) minimal failing input
+  std::size_t shrink(args_type &args, std::size_t max_steps = 10000) const
+  {
+    std::size_t steps = 0;
+    while (steps < max_steps &&
+           shrink_arg(args, std::integral_constant<std::size_t, 0>(),
+                      std::integral_constant<std::size_t, sizeof...(Gens)>())) {
+      ++steps;
+    }
+    return steps;
+  }
+
+  void run(const char *file, int line) const
+  {
+    const std::size_t n = global_unit_test_object_.property_cases;
+    const std::size_t failure = find_first_failure(n);
+    if (failure == n) {
+      return;
+    }
+    args_type args = generate(failure);
+    const std::size_t steps = shrink(args);
+    const auto print_counterexample = [&]() {
+      std::cout << failString() << "│ counterexample (case " << failure << " of " << n
+                << ", shrunk in " << steps << " steps): ";
+      print_args(args, indexes());
+      std::cout << '\n';
+    };
+    // repeat the minimal counterexample with the normal failure output; EXPECT_* and
+    // soft_checks() fail without throwing
+    const int failed_checks = global_unit_test_object_.failed_checks;
+    try {
+      call(args, indexes());
+    } catch (...) {
+      print_counterexample();
+      throw;
+    }
+    if (global_unit_test_object_.failed_checks > failed_checks) {
+      print_counterexample();
+      return;
+    }
+    Compare(file, line) << "property failed on case " << failure << " of " << n
+                        << " but passed when repeated. Is it deterministic?";
+  }
+};
+
+template <class F, class... Gens>
+inline void check_property(F f, const char *file, int line, const Gens &... gens)
+{
+  property_runner<F, Gens...>(f, gens...).run(file, line);
+}
+
+//}}}1
+}  // namespace detail
+}  // namespace test
+}  // namespace vir
+
+// TEST_PROPERTY {{{1
+/**
+ * TEST_PROPERTY(name, (parameter list), generators...) { body }
+ *
+ * Registers a test that evaluates the body on `--property-cases <n>` (default: 10000)
+ * inputs, where the i-th argument is drawn from the i-th generator. The cases are
+ * evaluated on all cores. The first failing input is shrunk to a minimal counterexample,
+ * which is then reported via the normal failure output.
+ */
+#define REAL_TEST_PROPERTY(name_, params_, ...)                                          \
+  namespace Tests                                                                        \
+  {                                                                                      \
+  struct name_##_ {                                                                      \
+    static void property params_;                                                        \
+    static void run()                                                                    \
+    {                                                                                    \
+      vir::test::detail::check_property(&property, __FILE__, __LINE__, __VA_ARGS__);     \
+    }                                                                                    \
+  };                                                                                     \
+  vir::test::detail::Test<name_##_> test_##name_##_(#name_);                             \
+  }                                                                                      \
+  void Tests::name_##_::property params_
+
+#define FAKE_TEST_PROPERTY(name_, params_, ...)                                          \
+  template <typename UnitTest_T_> void name_##_ params_
+
+#ifdef UNITTEST_ONLY_XTEST
+#define TEST_PROPERTY(name_, params_, ...) FAKE_TEST_PROPERTY(name_, params_, __VA_ARGS__)
+#define XTEST_PROPERTY(name_, params_, ...) REAL_TEST_PROPERTY(name_, params_, __VA_ARGS__)
+#else
+#define XTEST_PROPERTY(name_, params_, ...) FAKE_TEST_PROPERTY(name_, params_, __VA_ARGS__)
+#define TEST_PROPERTY(name_, params_, ...) REAL_TEST_PROPERTY(name_, params_, __VA_ARGS__)
+#endif
+
+//}}}1
+#endif  // VIR_PROPERTY_H_
+// vim: foldmethod=marker
@@ -0,0 +1,87 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+
+// The vir.test module for C++20 builds: replace `#include <vir/test.h>` with
+//
+//   import vir.test;
+//   #include <vir/test_macros.h>
+//
+// and link against virtest_module (see src/CMakeLists.txt). The module always uses the
+// library mode: the test runner and main are compiled into libvirtest. The standard
+// library headers are parsed once when the module is built instead of in every TU.
+
+module;
+#ifndef VIR_TEST_LIBRARY
+#define VIR_TEST_LIBRARY 1
+#endif
+#include "test.h"
+
+export module vir.test;
+export import vir.typelist;
+
+export namespace vir
+{
+using vir::typeToString;
+}  // namespace vir
+
+export namespace vir::test
+{
+using vir::test::do_not_optimize;
+using vir::test::clobber_memory;
+using vir::test::make_range_unknown;
+using vir::test::make_value_unknown;
+using vir::test::noinline;
+using vir::test::compare_traits;
+using vir::test::setFuzzyness;
+using vir::test::set_allowed_ulp_error;
+using vir::test::log_ulp_distance;
+using vir::test::asBytes;
+using vir::test::type;
+using vir::test::type1_t;
+using vir::test::type2_t;
+using vir::test::SKIP;
+using vir::test::ADD_PASS;
+using vir::test::set_timeout;
+using vir::test::soft_checks;
+using vir::test::thread;
+using vir::test::EXPECT_FAILURE;
+using vir::test::expect_failure;
+using vir::test::expect_assert_failure;
+using vir::test::initTest;
+using vir::test::runAll;
+using vir::test::finalize;
+}  // namespace vir::test
+
+// the entities the macros in test_macros.h name
+export namespace vir::test::detail
+{
+using vir::test::detail::Compare;
+using vir::test::detail::Test;
+using vir::test::detail::addTestInstantiations;
+using vir::test::detail::soft_check;
+}  // namespace vir::test::detail
@@ -28,66 +28,269 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef VIR_TEST_H_
 #define VIR_TEST_H_
 
+/* Library mode: if VIR_TEST_LIBRARY is defined, the test runner (UnitTester's
+ * out-of-line functions, initTest, runAll, finalize, and main) is only declared here and
+ * compiled once into libvirtest (src/virtest.cpp, which also defines
+ * VIR_TEST_IMPLEMENTATION). Otherwise every test executable consists of a single TU that
+ * includes the complete framework.
+ */
+#if defined VIR_TEST_LIBRARY && !defined VIR_TEST_IMPLEMENTATION
+#define VIR_TEST_DECLARATIONS_ONLY 1
+#endif
+#ifdef VIR_TEST_LIBRARY
+#define VIR_TEST_LINKAGE
+#else
+#define VIR_TEST_LINKAGE static
+#endif
+// Library mode references the shared runner state through references. Inline variables
+// avoid one copy per TU and, for the vir.test module (test.cppm), internal linkage.
+#ifdef __cpp_inline_variables
+#define VIR_TEST_SHARED_REF inline
+#else
+#define VIR_TEST_SHARED_REF static
+#endif
+
 #include "typelist.h"
 #include "typetostring.h"
 #include "detail/color.h"
 #include "detail/ulp.h"
+#include "detail/denormals.h"
 #include "detail/type_traits.h"
+#include "detail/random_seed.h"
+#include "detail/perf_counters.h"
+#include "detail/watchdog.h"
+#include "detail/check_hits.h"
+#ifndef VIR_TEST_DECLARATIONS_ONLY
+// only used by the runner
+#include "detail/mismatch.h"
+#include "detail/results.h"
+#endif
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cfenv>  // fesetround / FE_TONEAREST...
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
+#include <exception>
 #include <fstream>
+#include <initializer_list>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <sstream>
+#include <thread>
+#include <type_traits>
 #include <typeinfo>
+#include <utility>
 #include <vector>
 
 #ifdef HAVE_CXX_ABI_H
 #include <cxxabi.h>
 #endif
+#ifdef _MSC_VER
+#include <intrin.h>  // _ReturnAddress, _ReadWriteBarrier
+#endif
 
 namespace vir
 {
 namespace test
 {
-// make_value_unknown {{{
-#if __cplusplus < 201703
-template <bool> struct make_value_unknown_impl;
-template <> struct make_value_unknown_impl<true> {
-  template <class T> static VIR_ALWAYS_INLINE T apply(const T &x)
-  {
-    const volatile T &y = x;
-    return y;
-  }
+// do_not_optimize / clobber_memory / make_range_unknown {{{
+#ifdef __GNUC__
+#if defined __AVX512F__
+#define VIR_VECTOR_REGISTER_CONSTRAINT "v"
+#elif defined __SSE__
+#define VIR_VECTOR_REGISTER_CONSTRAINT "x"
+#elif defined __aarch64__ || defined __ARM_NEON
+#define VIR_VECTOR_REGISTER_CONSTRAINT "w"
+#endif
+
+namespace detail
+{
+#if defined __AVX512F__
+constexpr std::size_t vector_register_size = 64;
+#elif defined __AVX__
+constexpr std::size_t vector_register_size = 32;
+#elif defined VIR_VECTOR_REGISTER_CONSTRAINT
+constexpr std::size_t vector_register_size = 16;
+#else
+constexpr std::size_t vector_register_size = 0;
+#endif
+
+/**\internal
+ * GCC/clang vector types (`__attribute__((vector_size(N)))`) are the only non-class types
+ * that support the subscript operator on a value.
+ */
+template <class T, class = void> struct is_vector_builtin : std::false_type {
 };
-template <> struct make_value_unknown_impl<false> {
-  template <class T> static VIR_ALWAYS_INLINE T apply(const T &x)
-  {
-    T y = x;
-    asm("" : "+m"(y));
-    return y;
-  }
+template <class T>
+struct is_vector_builtin<T, decltype(void(std::declval<const T &>()[0]))>
+    : std::integral_constant<bool, !std::is_class<T>::value && !std::is_pointer<T>::value &&
+                                       !std::is_array<T>::value> {
 };
+
+/**\internal
+ * Selects the cheapest asm constraint that keeps a value of type \p T opaque:
+ * - \c gpr: integers, enums, and pointers in a general purpose register ("+r")
+ * - \c vreg: float, double, and vector builtins in a SIMD register ("+x", "+v", "+w")
+ * - \c vreg_bits: trivially copyable classes with the size of a SIMD register (e.g. simd
+ *   wrapper classes), copied to a vector builtin of equal size
+ * - \c memory: everything else ("+m")
+ */
+enum class barrier_kind { gpr, vreg, vreg_bits, memory };
+
+template <class T> constexpr std::size_t vreg_bits_size()
+{
+  return (sizeof(T) == 16 || sizeof(T) == 32 || sizeof(T) == 64) &&
+                 sizeof(T) <= vector_register_size
+             ? sizeof(T)
+             : 0;
+}
+
+template <class T> constexpr barrier_kind barrier_kind_of()
+{
+  return (std::is_integral<T>::value || std::is_enum<T>::value ||
+          std::is_pointer<T>::value) && sizeof(T) <= sizeof(void *)
+             ? barrier_kind::gpr
+#if defined __x86_64__ || defined __aarch64__
+             : std::is_floating_point<T>::value && sizeof(T) <= 8 ? barrier_kind::vreg
 #endif
-template <class T> VIR_ALWAYS_INLINE T make_value_unknown(const T &x)
+             : is_vector_builtin<T>::value && vector_register_size > 0 &&
+                       sizeof(T) <= vector_register_size
+                   ? barrier_kind::vreg
+                   : std::is_class<T>::value && std::is_trivially_copyable<T>::value &&
+                             vreg_bits_size<T>() > 0
+                         ? barrier_kind::vreg_bits
+                         : barrier_kind::memory;
+}
+
+template <barrier_kind K> using barrier_tag = std::integral_constant<barrier_kind, K>;
+
+template <class T> VIR_ALWAYS_INLINE void barrier(T &x, barrier_tag<barrier_kind::gpr>)
 {
-#if __cplusplus >= 201703
-  if constexpr (std::is_constructible_v<T, const volatile T &>) {
-    const volatile T &y = x;
-    return y;
-  } else {
-    T y = x;
-    asm("" : "+m"(y));
-    return y;
-  }
+  asm volatile("" : "+r"(x));
+}
+
+#ifdef VIR_VECTOR_REGISTER_CONSTRAINT
+template <class T> VIR_ALWAYS_INLINE void barrier(T &x, barrier_tag<barrier_kind::vreg>)
+{
+  asm volatile("" : "+" VIR_VECTOR_REGISTER_CONSTRAINT(x));
+}
+
+template <class T>
+VIR_ALWAYS_INLINE void barrier(T &x, barrier_tag<barrier_kind::vreg_bits>)
+{
+  typedef long long V [[gnu::vector_size(vreg_bits_size<T>())]];
+  V tmp;
+  std::memcpy(&tmp, &x, sizeof(V));
+  asm volatile("" : "+" VIR_VECTOR_REGISTER_CONSTRAINT(tmp));
+  std::memcpy(&x, &tmp, sizeof(V));
+}
+#endif
+
+template <class T> VIR_ALWAYS_INLINE void barrier(T &x, barrier_tag<barrier_kind::memory>)
+{
+  asm volatile("" : "+m"(x));
+}
+
+template <class T, barrier_kind K>
+VIR_ALWAYS_INLINE void barrier_const(const T &x, barrier_tag<K>)
+{
+  T y = x;
+  barrier(y, barrier_tag<K>());
+}
+
+template <class T>
+VIR_ALWAYS_INLINE void barrier_const(const T &x, barrier_tag<barrier_kind::memory>)
+{
+  asm volatile("" : : "m"(x));
+}
+}  // namespace detail
+
+/**
+ * Forces the compiler to have the value of \p x available (i.e. computed) at this point
+ * and to forget everything it knows about the value afterwards. Scalars and vectors stay
+ * in registers, thus the barrier itself costs no instructions.
+ */
+template <class T> VIR_ALWAYS_INLINE void do_not_optimize(T &x)
+{
+  detail::barrier(x, detail::barrier_tag<detail::barrier_kind_of<T>()>());
+}
+
+/**
+ * Forces the compiler to compute \p x at this point (e.g. the result of a function call).
+ */
+template <class T> VIR_ALWAYS_INLINE void do_not_optimize(const T &x)
+{
+  detail::barrier_const(x, detail::barrier_tag<detail::barrier_kind_of<T>()>());
+}
+
+/**
+ * Forces the compiler to complete all pending stores to memory and to reload all values
+ * from memory afterwards.
+ */
+VIR_ALWAYS_INLINE void clobber_memory() { asm volatile("" : : : "memory"); }
+
+/**
+ * Makes the compiler assume that the \p n objects starting at \p ptr were read and
+ * modified at this point.
+ */
+template <class T> VIR_ALWAYS_INLINE void make_range_unknown(T *ptr, std::size_t n)
+{
+  static_cast<void>(n);
+  asm volatile("" : : "r"(ptr) : "memory");
+}
+
+#else  // __GNUC__
+// Without GNU inline asm (i.e. MSVC) the object's address escapes through a volatile
+// store, followed by a compiler barrier.
+namespace detail
+{
+VIR_ALWAYS_INLINE void escape(const volatile void *ptr)
+{
+  static const volatile void *volatile sink;
+  sink = ptr;
+#ifdef _MSC_VER
+  _ReadWriteBarrier();
 #else
-  return make_value_unknown_impl<std::is_constructible<T, const volatile T &>::value>::apply(x);
+  std::atomic_signal_fence(std::memory_order_seq_cst);
 #endif
 }
+}  // namespace detail
+
+template <class T> VIR_ALWAYS_INLINE void do_not_optimize(T &x) { detail::escape(&x); }
+template <class T> VIR_ALWAYS_INLINE void do_not_optimize(const T &x) { detail::escape(&x); }
+
+VIR_ALWAYS_INLINE void clobber_memory()
+{
+#ifdef _MSC_VER
+  _ReadWriteBarrier();
+#else
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+template <class T> VIR_ALWAYS_INLINE void make_range_unknown(T *ptr, std::size_t n)
+{
+  static_cast<void>(n);
+  detail::escape(ptr);
+}
+#endif  // __GNUC__
+
+// }}}
+// make_value_unknown {{{
+template <class T> VIR_ALWAYS_INLINE T make_value_unknown(const T &x)
+{
+  T y = x;
+  do_not_optimize(y);
+  return y;
+}
 
 // }}}
 // noinline / NOINLINE {{{
@@ -166,6 +369,84 @@ template <> struct compare_traits<std::type_info, std::type_info>
   }
 };
 
+#ifdef __cpp_lib_experimental_parallel_simd
+// std::experimental::simd {{{1
+template <class T, class A>
+inline void log_ulp_distance(const std::experimental::simd<T, A> &ulp);
+
+/**
+ * Lane-wise comparison of std::experimental::simd objects. The check passes if all lanes
+ * compare equal (or are within the allowed ULP distance, which is computed for all lanes
+ * at once).
+ */
+template <class T, class A>
+struct compare_traits<std::experimental::simd<T, A>, std::experimental::simd<T, A>>
+{
+  using common_type = std::experimental::simd<T, A>;
+  using value_type = T;
+  static constexpr bool use_memcompare = false;
+  static constexpr bool is_fuzzy_comparable = std::is_floating_point<T>::value;
+  static inline bool is_equal(const common_type &a, const common_type &b)
+  {
+    return all_of(a == b);
+  }
+
+  static inline common_type ulp_distance(const common_type &a, const common_type &b)
+  {
+    return vir::detail::ulpDiffToReference(a, b);
+  }
+
+  static inline common_type ulp_distance_signed(const common_type &a,
+                                                const common_type &b)
+  {
+    return vir::detail::ulpDiffToReferenceSigned(a, b);
+  }
+
+  static inline bool ulp_compare_and_log(const common_type &ulp,
+                                         const value_type &allowed_distance)
+  {
+    log_ulp_distance(ulp);
+    return all_of(ulp <= allowed_distance);
+  }
+
+  template <class... Ts>
+  static inline std::string to_datafile_string(const common_type &d0, const Ts &... data)
+  {
+    std::ostringstream ss;
+    ss << std::setprecision(50);
+    for (std::size_t i = 0; i < d0.size(); ++i) {
+      ss << d0[i];
+      auto unused = {((ss << '\t' << lane(data, i)), 0)...};
+      (void)unused;
+      ss << '\n';
+    }
+    return ss.str();
+  }
+
+private:
+  template <class U> static const U &lane(const U &x, std::size_t) { return x; }
+  template <class U, class B>
+  static U lane(const std::experimental::simd<U, B> &x, std::size_t i)
+  {
+    return x[i];
+  }
+};
+
+template <class T, class A>
+struct compare_traits<std::experimental::simd_mask<T, A>,
+                      std::experimental::simd_mask<T, A>>
+{
+  using common_type = std::experimental::simd_mask<T, A>;
+  using value_type = common_type;
+  static constexpr bool use_memcompare = false;
+  static constexpr bool is_fuzzy_comparable = false;
+  static inline bool is_equal(const common_type &a, const common_type &b)
+  {
+    return all_of(a == b);
+  }
+};
+#endif  // __cpp_lib_experimental_parallel_simd
+
 
 /** \internal
  * Implementation namespace
@@ -173,7 +454,7 @@ template <> struct compare_traits<std::type_info, std::type_info>
 namespace detail
 {
 // printPass {{{1
-static inline void printPass()
+inline void printPass()
 {
   static const char *str = 0;
   if (str == 0) {
@@ -187,7 +468,7 @@ static inline void printPass()
   }
   std::cout << str;
 }
-static inline void printSkip()
+inline void printSkip()
 {
   std::cout << vir::detail::color::yellow << " SKIP: " << vir::detail::color::normal;
 }
@@ -229,20 +510,87 @@ public:
       plotFile.close();
     }
     m_finalized = true;
+    writeState();
+    if (resultsFile.is_open()) {
+      resultsFile << "END\t" << passedTests << '\t' << failedTests << '\t' << skippedTests
+                  << '\n';
+      resultsFile.close();
+    }
+    if (check_hits_report) {
+      check_hits_report(std::cout);
+    }
+    if (failedTests > 0 && compile_time_seeds.size() == 1) {
+      // VIR_CHOOSE_ONE_RANDOMLY and VIR_CHOOSE_K_RANDOMLY make the same choices again
+      const unsigned seed = *compile_time_seeds.begin();
+      std::cout << "\n compile-time seed: " << seed
+                << " (rebuild with -DVIR_COMPILE_TIME_SEED=" << seed << ")";
+    } else if (failedTests > 0 && compile_time_seeds.size() > 1) {
+      std::cout << "\n compile-time seeds:";
+      for (unsigned seed : compile_time_seeds) {
+        std::cout << ' ' << seed;
+      }
+      std::cout << " (the test TUs were built with different VIR_COMPILE_TIME_SEED)";
+    }
     std::cout << "\n Testing done. " << passedTests << " tests passed. " << failedTests
               << " tests failed. " << skippedTests << " tests skipped." << std::endl;
     return failedTests;
   }
 
+  void runTest(TestFunction fun, const char *name);
   void runTestInt(TestFunction fun, const char *name);
+  void runTestForked(TestFunction fun, const char *name);
+  void appendPerfCounters(const char *name);
+  void readState();
+  void writeState();
+  void recordResult(const char *name, const char *status);
+
+  // whether the calling thread runs the current test (or no test runs at all)
+  bool on_test_thread() const
+  {
+    return test_thread == std::thread::id() || test_thread == std::this_thread::get_id();
+  }
 
-  bool status;
+  std::atomic<bool> status;  // checks on other threads may fail concurrently
+  std::thread::id test_thread;  // the thread running the current test
   bool expect_failure;
   bool expect_assert_failure;
   bool test_roundingmodes = false;
+  bool test_denormal_modes = false;
   const char *only_name;
   const char *test_name = nullptr;
   bool vim_lines = false;
+  bool run_benchmarks = false;
+  bool list_tests = false;  // --list: print the test names instead of running them
+  const char *bench_baseline = nullptr;  // file to store benchmark samples to
+  const char *bench_compare = nullptr;   // file with benchmark samples to compare against
+  double bench_threshold = 0.05;         // relative slowdown that counts as regression
+  const char *bench_csv = nullptr;       // file to write the benchmark results to
+  const char *bench_reference = nullptr; // type the speedups are relative to
+  void (*bench_report)() = nullptr;      // set by benchmark.h, called after benchmarks
+  void (*test_started)() = nullptr;      // set by testalloc.h, called before every test
+  void (*test_finished)() = nullptr;     // set by testalloc.h, called after every test
+  void (*check_hits_report)(std::ostream &) = nullptr;  // set with VIR_TEST_CHECK_HITS
+  std::size_t property_cases = 10000;
+  double timeout = 0;  // seconds per test, > 0 runs every test in a child process
+  bool soft_checks = false;  // failing checks of the current test do not end it
+  int max_failures = 10;     // failed soft checks after which the test ends anyway
+  std::atomic<int> failed_checks{0};  // of the current test
+  std::string state_file;  // failed and skipped tests of the last run, empty: disabled
+  bool rerun_failed = false;  // run only the tests recorded in state_file
+  bool failed_first = false;  // run the tests recorded in state_file first
+  std::map<std::string, std::string> last_state;  // test name -> FAIL/SKIP
+  std::map<std::string, std::string> state;       // of the current run
+  std::set<std::string> ran;                      // names of the tests of the current run
+  std::set<unsigned> compile_time_seeds;  // of the test TUs, see compile_time_rand
+  std::string test_details;  // appended to the PASS/FAIL line of the current test
+  vir::detail::perf_counters perfCounters;  // --perf-counters
+  std::ofstream perfFile;                   // --perf-output
+  std::ofstream resultsFile;                // --results
+  std::chrono::steady_clock::time_point test_start;
+  std::size_t shard_index = 0;  // --shard <index>/<count>
+  std::size_t shard_count = 1;
+  double sample_fraction = 0;   // --sample <fraction>
+  std::size_t sample_count = 0;  // --sample <count>
   std::fstream plotFile;
 
   template <class T> T &fuzzyness()
@@ -256,6 +604,7 @@ private:
   int failedTests;
 
 public:
+  int failedTestCount() const { return failedTests; }
   int passedTests;
   int skippedTests;
   bool findMaximumDistance;
@@ -264,23 +613,132 @@ public:
   int meanCount;
 };
 
+#ifdef VIR_TEST_LIBRARY
+// a function-local static is initialized before the first test registers, independent of
+// the initialization order of the TUs
+UnitTester &unit_tester();
+VIR_TEST_SHARED_REF UnitTester &global_unit_test_object_ = unit_tester();
+#else
 static UnitTester global_unit_test_object_;
+#endif
+
+#if defined VIR_HAVE_COMPILE_TIME_SEED && !defined VIR_TEST_IMPLEMENTATION
+namespace
+{
+/**\internal
+ * Records the compile-time seed of every TU that includes this header, so that finalize
+ * prints the seed of the tests rather than the one of libvirtest. Internal linkage: the
+ * seed may differ per TU.
+ */
+struct record_compile_time_seed {
+  record_compile_time_seed()
+  {
+    global_unit_test_object_.compile_time_seeds.insert(vir::compile_time_rand::seed());
+  }
+} record_compile_time_seed_;
+}  // namespace
+#endif
+
+#ifdef VIR_TEST_CHECK_HITS
+namespace
+{
+/**\internal
+ * Lets finalize print the check hits also if it was compiled without VIR_TEST_CHECK_HITS
+ * (libvirtest in library mode).
+ */
+struct enable_check_hits_report {
+  enable_check_hits_report()
+  {
+    global_unit_test_object_.check_hits_report = &vir::detail::print_check_hits;
+  }
+} enable_check_hits_report_;
+}  // namespace
+#endif
+
+// soft_check {{{1
+/**\internal
+ * The number of EXPECT_* checks currently evaluated on this thread.
+ */
+inline int &soft_check_depth()
+{
+  static thread_local int depth = 0;
+  return depth;
+}
+
+/**\internal
+ * Makes the check it is sequenced before (in the same full-expression) non-fatal. As a
+ * temporary it is destroyed after the Compare object, whose destructor reports failure.
+ */
+struct soft_check {
+  soft_check() { ++soft_check_depth(); }
+  ~soft_check() { --soft_check_depth(); }
+  soft_check(const soft_check &) = delete;
+  soft_check &operator=(const soft_check &) = delete;
+};
 
-static const char *failString()  // {{{1
+// quiet_checks {{{1
+/**\internal
+ * While set, failing checks on this thread neither print nor change the test status. They
+ * only throw UnitTestFailure. This is used to evaluate test cases on worker threads.
+ */
+inline bool &quiet_checks()
+{
+  static thread_local bool quiet = false;
+  return quiet;
+}
+
+// checked_thread {{{1
+/**\internal
+ * Whether this thread was started by vir::test::thread. Failing checks on such a thread
+ * are fatal (as on the test thread), because its constructor catches the exception and
+ * join() rethrows it on the test thread.
+ */
+inline bool &checked_thread()
+{
+  static thread_local bool checked = false;
+  return checked;
+}
+
+// failure output {{{1
+/**\internal
+ * A failing check composes its message in the buffer of its thread and prints it with one
+ * write under report_mutex(). Thus failures on concurrent threads do not interleave.
+ */
+inline std::ostringstream &failure_buffer()
+{
+  static thread_local std::ostringstream buffer;
+  return buffer;
+}
+
+/**\internal
+ * Serializes failure output and the --maxdist statistics of concurrent checks.
+ */
+inline std::mutex &report_mutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+#ifdef VIR_TEST_DECLARATIONS_ONLY
+const char *failString();
+#else
+#ifdef VIR_TEST_LIBRARY
+UnitTester &unit_tester()  // {{{1
+{
+  static UnitTester tester;
+  return tester;
+}
+#endif
+
+VIR_TEST_LINKAGE const char *failString()  // {{{1
 {
   if (global_unit_test_object_.expect_failure) {
     return "XFAIL: ";
   }
-  static const char *str = 0;
-  if (str == 0) {
-    if (vir::detail::may_use_color(std::cout)) {
-      static const char *const fail = " \033[1;40;31mFAIL:\033[0m ";
-      str = fail;
-    } else {
-      static const char *const fail = " FAIL: ";
-      str = fail;
-    }
-  }
+  // initialized once, even if checks fail concurrently
+  static const char *const str = vir::detail::may_use_color(std::cout)
+                                     ? " \033[1;40;31mFAIL:\033[0m "
+                                     : " FAIL: ";
   return str;
 }
 
@@ -290,20 +748,37 @@ void UnitTester::runTestInt(TestFunction fun, const char *name)  //{{{1
       0 != std::strcmp(name, global_unit_test_object_.only_name)) {
     return;
   }
+  ran.insert(name);
+  test_thread = std::this_thread::get_id();
+  failure_buffer().str(std::string());
   global_unit_test_object_.status = true;
   global_unit_test_object_.expect_failure = false;
   global_unit_test_object_.test_name = name;
+  soft_checks = false;
+  failed_checks = 0;
+  test_start = std::chrono::steady_clock::now();
+  vir::detail::global_random_state().test_key = vir::detail::hash_name(name);
+  vir::detail::global_random_state().used = false;
+  test_details.clear();
+  if (test_started) {
+    test_started();
+  }
   try {
     setFuzzyness<float>(1);
     setFuzzyness<double>(1);
     maximumDistance = 0.;
     meanDistance = 0.;
     meanCount = 0;
+    perfCounters.start();
     fun();
+    perfCounters.stop();
   } catch (const SkippedTest &skip) {
+    perfCounters.stop();
     printSkip();
     std::cout << name << ' ' << skip.message << std::endl;
+    state[name] = "SKIP";
     ++skippedTests;
+    recordResult(name, "SKIP");
     return;
   } catch (UnitTestFailure) {
   } catch (std::exception &e) {
@@ -315,14 +790,22 @@ void UnitTester::runTestInt(TestFunction fun, const char *name)  //{{{1
               << " threw an unexpected exception, of unknown type\n";
     global_unit_test_object_.status = false;
   }
+  perfCounters.stop();
+  appendPerfCounters(name);
+  if (test_finished) {
+    test_finished();
+  }
   if (global_unit_test_object_.expect_failure) {
     if (!global_unit_test_object_.status) {
-      std::cout << "XFAIL: " << name << std::endl;
+      std::cout << "XFAIL: " << name << test_details << std::endl;
+      recordResult(name, "XFAIL");
     } else {
       std::cout << "unexpected PASS: " << name
                 << "\n    This test should have failed but didn't. Check the code!"
                 << std::endl;
+      state[name] = "FAIL";
       ++failedTests;
+      recordResult(name, "FAIL");
     }
   } else {
     if (!global_unit_test_object_.status) {
@@ -330,15 +813,29 @@ void UnitTester::runTestInt(TestFunction fun, const char *name)  //{{{1
         std::cout << failString() << "│ with a maximal distance of " << maximumDistance
                   << " to the reference (mean: " << meanDistance / meanCount << ").\n";
       }
+      if (vir::detail::global_random_state().used) {
+        const auto seed = vir::detail::global_random_state().seed;
+        std::cout << failString() << "│ random seed: " << seed << " (replay with --seed "
+                  << seed << ")\n";
+      }
+      if (failed_checks > 1) {
+        std::cout << failString() << "│ " << failed_checks.load() << " failed checks";
+        if (failed_checks >= max_failures) {
+          std::cout << ", stopped at --max-failures " << max_failures;
+        }
+        std::cout << '\n';
+      }
       std::cout << failString();
       if (!vim_lines) {
         std::cout << "┕ ";
       }
-      std::cout << name << std::endl;
+      std::cout << name << test_details << std::endl;
       if (vim_lines) {
         std::cout << '\n';
       }
+      state[name] = "FAIL";
       ++failedTests;
+      recordResult(name, "FAIL");
     } else {
       printPass();
       std::cout << name;
@@ -350,17 +847,183 @@ void UnitTester::runTestInt(TestFunction fun, const char *name)  //{{{1
           std::cout << " all values matched the reference precisely.";
         }
       }
-      std::cout << std::endl;
+      std::cout << test_details << std::endl;
+      ++passedTests;
+      recordResult(name, "PASS");
+    }
+  }
+}
+
+void UnitTester::readState()  //{{{1
+{
+  std::ifstream file(state_file);
+  std::string line;
+  while (std::getline(file, line)) {
+    const auto tab = line.find('\t');
+    if (tab != std::string::npos) {
+      last_state[line.substr(tab + 1)] = line.substr(0, tab);
+    }
+  }
+}
+
+/**\internal
+ * Writes the failed and skipped tests of this run to state_file. Entries of the previous
+ * run are kept for tests that did not run this time (e.g. because of --only).
+ */
+void UnitTester::writeState()  //{{{1
+{
+  if (state_file.empty()) {
+    return;
+  }
+  for (const auto &entry : last_state) {
+    if (ran.count(entry.first) == 0) {
+      state.insert(entry);
+    }
+  }
+  std::ofstream file(state_file);
+  for (const auto &entry : state) {
+    file << entry.second << '\t' << entry.first << '\n';
+  }
+}
+
+void UnitTester::recordResult(const char *name, const char *status)  //{{{1
+{
+  if (!resultsFile.is_open()) {
+    return;
+  }
+  vir::detail::test_result r;
+  r.status = status;
+  r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - test_start)
+                  .count();
+  r.max_ulp = maximumDistance;
+  r.sum_ulp = meanDistance;
+  r.ulp_count = meanCount;
+  r.name = name;
+  vir::detail::write_result(resultsFile, r);
+}
+void UnitTester::runTest(TestFunction fun, const char *name)  //{{{1
+{
+#if VIR_HAVE_WATCHDOG
+  if (timeout > 0 && (!only_name || 0 == std::strcmp(name, only_name))) {
+    runTestForked(fun, name);
+    return;
+  }
+#endif
+  runTestInt(fun, name);
+}
+
+#if VIR_HAVE_WATCHDOG
+void UnitTester::runTestForked(TestFunction fun, const char *name)  //{{{1
+{
+  enum : int { child_passed = 64, child_failed, child_skipped, child_xfailed };
+  // the child inherits the stream buffers, which must not be written twice
+  std::cout.flush();
+  resultsFile.flush();
+  perfFile.flush();
+  plotFile.flush();
+  const int passed = passedTests;
+  const int failed = failedTests;
+  const int skipped = skippedTests;
+  test_start = std::chrono::steady_clock::now();
+  const pid_t child = vir::detail::watchdog::start(timeout);
+  if (child == 0) {
+    perfCounters.reopen();  // the inherited counters count the runner
+    runTestInt(fun, name);
+    std::cout.flush();
+    resultsFile.flush();
+    perfFile.flush();
+    plotFile.flush();
+    std::_Exit(failedTests > failed     ? child_failed
+               : skippedTests > skipped ? child_skipped
+               : passedTests > passed   ? child_passed
+                                        : child_xfailed);
+  } else if (child < 0) {
+    std::cout << "cannot start a child process for " << name
+              << ", running it without timeout\n";
+    runTestInt(fun, name);
+    return;
+  }
+  ran.insert(name);
+  int status = 0;
+  const bool exited = vir::detail::watchdog::wait(child, status);
+  if (exited && WIFEXITED(status)) {
+    switch (WEXITSTATUS(status)) {
+    case child_passed:
       ++passedTests;
+      return;
+    case child_failed:
+      state[name] = "FAIL";
+      ++failedTests;
+      return;
+    case child_skipped:
+      state[name] = "SKIP";
+      ++skippedTests;
+      return;
+    case child_xfailed:
+      return;
     }
   }
+  // the test timed out, crashed, or ended the process itself
+  if (!exited) {
+    const auto &shared = *vir::detail::watchdog::shared();
+    std::cout << failString() << "┍ " << name << " timed out after "
+              << shared.seconds.load() << " s\n";
+    if (const char *file = shared.file.load(std::memory_order_relaxed)) {
+      std::cout << failString() << "│ last failed check: " << file << ':'
+                << shared.line.load(std::memory_order_relaxed) << '\n';
+    } else {
+      std::cout << failString() << "│ no check failed before\n";
+    }
+  } else if (WIFSIGNALED(status)) {
+    std::cout << failString() << "┍ " << name << " was terminated by signal "
+              << WTERMSIG(status) << '\n';
+  } else {
+    std::cout << failString() << "┍ " << name << " exited with status "
+              << WEXITSTATUS(status) << '\n';
+  }
+  std::cout << failString();
+  if (!vim_lines) {
+    std::cout << "┕ ";
+  }
+  std::cout << name << std::endl;
+  state[name] = "FAIL";
+  ++failedTests;
+  recordResult(name, "FAIL");
 }
+#endif  // VIR_HAVE_WATCHDOG
+
+void UnitTester::appendPerfCounters(const char *name)  //{{{1
+{
+  if (!perfCounters.active()) {
+    return;
+  }
+  std::ostringstream s;
+  s << " [";
+  const char *sep = "";
+  for (const auto &counter : perfCounters.read()) {
+    s << sep << counter.first << '=' << counter.second;
+    sep = " ";
+    if (perfFile.is_open()) {
+      perfFile << name << '\t' << counter.first << '\t' << counter.second << '\n';
+    }
+  }
+  if (perfCounters.running_fraction() < 1.) {
+    // multiplexed: the counts are extrapolated from part of the run time
+    s << " scaled, counted " << static_cast<int>(perfCounters.running_fraction() * 100.)
+      << "% of the time";
+  }
+  s << ']';
+  test_details += s.str();
+}
+#endif  // VIR_TEST_DECLARATIONS_ONLY
 
 // log_ulp_distance {{{1
 }  // namespace detail
 template <typename T> inline void log_ulp_distance(T ulp)
 {
-  if (VIR_IS_UNLIKELY(detail::global_unit_test_object_.findMaximumDistance)) {
+  if (VIR_IS_UNLIKELY(detail::global_unit_test_object_.findMaximumDistance) &&
+      !detail::quiet_checks()) {
+    std::lock_guard<std::mutex> lock(detail::report_mutex());
     using std::abs;
     decltype(detail::global_unit_test_object_.maximumDistance) x = abs(ulp);
     detail::global_unit_test_object_.maximumDistance =
@@ -369,8 +1032,36 @@ template <typename T> inline void log_ulp_distance(T ulp)
     ++detail::global_unit_test_object_.meanCount;
   }
 }
+#ifdef __cpp_lib_experimental_parallel_simd
+template <class T, class A>
+inline void log_ulp_distance(const std::experimental::simd<T, A> &ulp)
+{
+  if (VIR_IS_UNLIKELY(detail::global_unit_test_object_.findMaximumDistance)) {
+    for (std::size_t i = 0; i < ulp.size(); ++i) {
+      log_ulp_distance(T(ulp[i]));
+    }
+  }
+}
+#endif  // __cpp_lib_experimental_parallel_simd
+
 namespace detail
 {
+#ifdef __cpp_lib_experimental_parallel_simd
+/**\internal
+ * Returns the comma-separated indexes of the lanes that are false in \p ok.
+ */
+template <class T, class A>
+inline std::string mismatched_lanes(const std::experimental::simd_mask<T, A> &ok)
+{
+  std::string lanes;
+  for (std::size_t i = 0; i < ok.size(); ++i) {
+    if (!ok[i]) {
+      lanes += (lanes.empty() ? "" : ", ") + std::to_string(i);
+    }
+  }
+  return lanes;
+}
+#endif  // __cpp_lib_experimental_parallel_simd
 
 class Compare  //{{{1
 {
@@ -414,6 +1105,7 @@ public:
   struct AbsoluteError {};
   struct RelativeError {};
   struct Mem {};
+  struct MemRange {};
 
   // require_fuzzy_compare {{{2
   template <class Traits> static constexpr bool require_fuzzy_compare()
@@ -432,10 +1124,10 @@ public:
                                             !require_fuzzy_compare<Traits>()>::type>
   VIR_ALWAYS_INLINE Compare(const T1 &a, const T2 &b, const char *_a, const char *_b,
                             const char *_file, int _line)
-      : m_ip(getIp()), m_failed(!Traits::is_equal(a, b))
+      : m_failed(!Traits::is_equal(a, b))
   {
     if (VIR_IS_UNLIKELY(m_failed)) {
-      printFailure(a, b, _a, _b, _file, _line);
+      printFailure<T1, T2>(a, b, _a, _b, _file, _line);
     }
   }
 
@@ -445,28 +1137,12 @@ public:
             class = T1>
   VIR_ALWAYS_INLINE Compare(const T1 &a, const T2 &b, const char *_a, const char *_b,
                             const char *_file, int _line)
-      : m_ip(getIp())
-      , m_failed(!Traits::ulp_compare_and_log(Traits::ulp_distance(a, b), 1))
+      : m_failed(!Traits::ulp_compare_and_log(Traits::ulp_distance(a, b), 1))
   {
     if (VIR_IS_UNLIKELY(m_failed)) {
-      printFirst();
-      printPosition(_file, _line);
-      print(_a);
-      print(" (");
-      print(std::setprecision(10));
-      print(a);
-      print(") ≈ ");
-      print(_b);
-      print(" (");
-      print(std::setprecision(10));
-      print(b);
-      print(std::setprecision(6));
-      print(") -> ");
-      print(a == b);
-      print("\ndistance: ");
-      print(Traits::ulp_distance_signed(a, b));
-      print(" ulp, allowed distance: ±1 ulp (automatic fuzzy compare to work around x87 quirks)");
-      print(' ');
+      printUlpFailure<Traits, T1, T2, int>(
+          a, b, _a, _b, _file, _line, 1,
+          " ulp (automatic fuzzy compare to work around x87 quirks)");
     }
   }
 
@@ -484,28 +1160,29 @@ public:
   VIR_ALWAYS_INLINE Compare(const T1 &valueA, const T2 &valueB, const char *variableNameA,
                             const char *variableNameB, const char *filename, int line,
                             Mem)
-      : m_ip(getIp()), m_failed(0 != std::memcmp(&valueA, &valueB, sizeof(T1)))
+      : m_failed(0 != std::memcmp(&valueA, &valueB, sizeof(T1)))
   {
     static_assert(
         sizeof(T1) == sizeof(T2),
         "MEMCOMPARE requires both of its arguments to have the same size (equal sizeof)");
     if (VIR_IS_UNLIKELY(m_failed)) {
-      printFirst();
-      printPosition(filename, line);
-      print("MEMCOMPARE(");
-      print(variableNameA);
-      print(", ");
-      print(variableNameB);
-      const int endian_test = 1;
-      if (reinterpret_cast<const char *>(&endian_test)[0] == 1) {
-        print("), memory contents (little-endian):\n");
-      } else {
-        print("), memory contents (big-endian):\n");
-      }
-      printMem(valueA);
-      print('\n');
-      printMem(valueB);
-      print(' ');
+      printMemFailure(valueA, valueB, variableNameA, variableNameB, filename, line);
+    }
+  }
+
+  // MemRange Compare ctor {{{2
+  template <class T1, class T2>
+  VIR_ALWAYS_INLINE Compare(const T1 *a, const T2 *b, std::size_t n, const char *_a,
+                            const char *_b, const char *_n, const char *_file, int _line,
+                            MemRange)
+      : m_failed(n > 0 && 0 != std::memcmp(a, b, n * sizeof(T1)))
+  {
+    static_assert(sizeof(T1) == sizeof(T2),
+                  "MEMCOMPARE_RANGE requires elements of equal size (equal sizeof)");
+    if (VIR_IS_UNLIKELY(m_failed)) {
+      printMemRangeFailure(reinterpret_cast<const unsigned char *>(a),
+                           reinterpret_cast<const unsigned char *>(b), n * sizeof(T1), _a,
+                           _b, _n, _file, _line);
     }
   }
 
@@ -550,39 +1227,15 @@ public:
                             const char *_file, int _line, Fuzzy2,
                             typename Traits::value_type allowed_distance,
                             Ts &&... extra_data)
-      : m_ip(getIp())
-      , m_failed(
+      : m_failed(
             !Traits::ulp_compare_and_log(Traits::ulp_distance(a, b), allowed_distance))
   {
     if (VIR_IS_UNLIKELY(m_failed)) {
-      noinline([&]() {
-        printFirst();
-        printPosition(_file, _line);
-        print(_a);
-        print(" (");
-        print(std::setprecision(10));
-        print(a);
-        print(") ≈ ");
-        print(_b);
-        print(" (");
-        print(std::setprecision(10));
-        print(b);
-        print(std::setprecision(6));
-        print(") -> ");
-        print(a == b);
-        print("\ndistance: ");
-        print(Traits::ulp_distance_signed(a, b));
-        print(" ulp, allowed distance: ±");
-        print(allowed_distance);
-        print(" ulp");
-        print(' ');
-      });
-    }
-    if (global_unit_test_object_.plotFile.is_open()) {
-      noinline([&]() {
-        global_unit_test_object_.plotFile << Traits::to_datafile_string(
-            b, Traits::ulp_distance_signed(a, b), static_cast<Ts &&>(extra_data)...);
-      });
+      printUlpFailure<Traits, T1, T2, typename Traits::value_type>(
+          a, b, _a, _b, _file, _line, allowed_distance, " ulp");
+    }
+    if (global_unit_test_object_.plotFile.is_open() && !quiet_checks()) {
+      writePlotData<Traits>(a, b, static_cast<Ts &&>(extra_data)...);
     }
   }
 
@@ -590,39 +1243,10 @@ public:
   template <typename T, typename ET>
   VIR_ALWAYS_INLINE Compare(const T &a, const T &b, const char *_a, const char *_b,
                            const char *_file, int _line, AbsoluteError, ET error)
-      : m_ip(getIp()), m_failed(absoluteErrorTest(a, b, error))
+      : m_failed(absoluteErrorTest(a, b, error))
   {
     if (VIR_IS_UNLIKELY(m_failed)) {
-      noinline([&]() {
-        printFirst();
-        printPosition(_file, _line);
-        print(_a);
-        print(" (");
-        print(std::setprecision(10));
-        print(a);
-        print(") ≈ ");
-        print(_b);
-        print(" (");
-        print(std::setprecision(10));
-        print(b);
-        print(std::setprecision(6));
-        print(") -> ");
-        print(a == b);
-        print("\ndifference: ");
-        if (a > b) {
-          print(a - b);
-        } else {
-          print('-');
-          print(b - a);
-        }
-        print(", allowed difference: ±");
-        print(error);
-        print("\ndistance: ");
-        using vir::detail::ulpDiffToReferenceSigned;
-        print(ulpDiffToReferenceSigned(a, b));
-        print(" ulp");
-        print(' ');
-      });
+      printAbsoluteErrorFailure<T, ET>(a, b, _a, _b, _file, _line, error);
     }
   }
 
@@ -630,70 +1254,27 @@ public:
   template <typename T, typename ET>
   VIR_ALWAYS_INLINE Compare(const T &a, const T &b, const char *_a, const char *_b,
                            const char *_file, int _line, RelativeError, ET error)
-      : m_ip(getIp()), m_failed(relativeErrorTest(a, b, error))
+      : m_failed(relativeErrorTest(a, b, error))
   {
     if (VIR_IS_UNLIKELY(m_failed)) {
-      noinline([&]() {
-        printFirst();
-        printPosition(_file, _line);
-        print(_a);
-        print(" (");
-        print(std::setprecision(10));
-        print(a);
-        print(") ≈ ");
-        print(_b);
-        print(" (");
-        print(std::setprecision(10));
-        print(b);
-        print(std::setprecision(6));
-        print(") -> ");
-        print(a == b);
-        print("\nrelative difference: ");
-        if (a > b) {
-          print((a - b) / (b > 0 ? b : -b));
-        } else {
-          print('-');
-          print((b - a) / (b > 0 ? b : -b));
-        }
-        print(", allowed: ±");
-        print(error);
-        print("\nabsolute difference: ");
-        if (a > b) {
-          print(a - b);
-        } else {
-          print('-');
-          print(b - a);
-        }
-        print(", allowed: ±");
-        print(error * (b > 0 ? b : -b));
-        print("\ndistance: ");
-        using vir::detail::ulpDiffToReferenceSigned;
-        print(ulpDiffToReferenceSigned(a, b));
-        print(" ulp");
-        print(' ');
-      });
+      printRelativeErrorFailure<T, ET>(a, b, _a, _b, _file, _line, error);
     }
   }
 
   // VERIFY ctor {{{2
   VIR_ALWAYS_INLINE Compare(bool good, const char *cond, const char *_file, int _line)
-      : m_ip(getIp()), m_failed(!good)
+      : m_failed(!good)
   {
     if (VIR_IS_UNLIKELY(m_failed)) {
-      noinline([&]() {
-        printFirst();
-        printPosition(_file, _line);
-        print(cond);
-        print(' ');
-      });
+      printVerifyFailure(cond, _file, _line);
     }
   }
 
   // FAIL ctor {{{2
-  VIR_NEVER_INLINE Compare(const char *_file, int _line) : m_ip(getIp()), m_failed(true)
+  VIR_NEVER_INLINE Compare(const char *_file, int _line) : m_failed(true)
   {
     printFirst();
-    printPosition(_file, _line);
+    printPosition(_file, _line, callerIp());
     print(' ');
   }
 
@@ -701,7 +1282,7 @@ public:
   template <typename... Ts> VIR_ALWAYS_INLINE const Compare& on_failure(const Ts&... xs) const
   {
     if (VIR_IS_UNLIKELY(m_failed)) {
-      noinline([&]() { [[maybe_unused]] int tmp[] = {(print(xs), 0)...}; });
+      printAll(xs...);
     }
     return *this;
   }
@@ -748,176 +1329,499 @@ public:
 
   // }}}2
 private:
-  static VIR_ALWAYS_INLINE size_t getIp()  //{{{2
+  /**\internal
+   * Returns the return address of the (non-inlined) function this is inlined into. All
+   * failure paths are cold functions called directly from the check, thus the address
+   * identifies the failed check without costing anything on the pass path.
+   */
+  static VIR_ALWAYS_INLINE size_t callerIp()  //{{{2
   {
-    size_t _ip = 0;
 #ifdef __GNUC__
-#ifdef __x86_64__
-    asm volatile("lea 0(%%rip),%0" : "=r"(_ip));
-#elif defined __i386__
-    asm volatile("1: movl $1b,%0" : "=r"(_ip));
-#elif defined __arm__
-    asm volatile("mov %0,pc" : "=r"(_ip));
-#elif defined __aarch64__
-    asm volatile("adr %0,." : "=r"(_ip));
+    return reinterpret_cast<size_t>(__builtin_return_address(0));
+#elif defined _MSC_VER
+    return reinterpret_cast<size_t>(_ReturnAddress());
+#else
+    return 0;
 #endif
-#endif  //__GNUC__
-    return _ip;
   }
 
   static char hexChar(char x) { return x + (x > 9 ? 87 : 48); }
-  template <typename T> static void printMem(const T &x)  // {{{2
+
+  // cold failure paths {{{2
+  /**\internal
+   * A reference to a value together with the function that prints it. The failure paths
+   * of the check templates only collect type_erased references and pass them to the one
+   * non-template reportFailure. Thus, a check on a new type adds a small formatTo
+   * instantiation to the binary, but no copy of the message layout.
+   */
+  struct type_erased {
+    const void *value;
+    void (*format)(std::ostream &, const void *);  // nullptr: prints nothing
+  };
+  template <typename T> static void formatErased(std::ostream &s, const void *x)
   {
-    constexpr std::size_t length = sizeof(T) * 2 + sizeof(T) / 4;
-    std::array<char, length + 3> tmp;
-    tmp[0] = '0';
-    tmp[1] = 'x';
-    char *s = &tmp[2];
-    std::memset(s, '\'', length - 1);
-    s[length - 1] = '\0';
-    s[length] = '\0';
-    const auto bytes = reinterpret_cast<const std::uint8_t *>(&x);
-    for (std::size_t i = 0; i < sizeof(T); ++i) {
-      s[i * 2 + i / 4] = hexChar(bytes[i] >> 4);
-      s[i * 2 + 1 + i / 4] = hexChar(bytes[i] & 0xf);
-    }
-    std::cout << tmp.data();
+    formatTo(s, *static_cast<const T *>(x));
+  }
+  template <typename T> static type_erased eraseType(const T &x)
+  {
+    return {&x, &formatErased<T>};
   }
 
-  // printFailure {{{2
+  struct failure_report {
+    const char *file;
+    int line;
+    size_t ip;
+    const char *name_a;  // nullptr: the message consists of `details` only
+    const char *op;
+    const char *name_b;
+    type_erased value_a;
+    type_erased value_b;
+    const char *details;  // every '%' is replaced by the next entry of `args`
+    std::initializer_list<type_erased> args;
+  };
+
+  static VIR_COLD void reportFailure(const failure_report &r);
+
+  /**\internal
+   * The failure paths take small trivially copyable operands by value. Thus a check in a
+   * loop need not keep its operands (e.g. the loop counter) in memory for the failure
+   * path to take their addresses.
+   */
+  template <typename T>
+  using cold_arg = typename std::conditional<std::is_trivially_copyable<T>::value &&
+                                                 !std::is_array<T>::value &&
+                                                 sizeof(T) <= 2 * sizeof(void *),
+                                             T, const T &>::type;
+
   template <typename T1, typename T2>
-  void printFailure(const T1 &a, const T2 &b, const char *_a, const char *_b,
-                    const char *_file, int _line);
+  static VIR_COLD void printFailure(cold_arg<T1> a, cold_arg<T2> b, const char *_a,
+                                    const char *_b, const char *_file, int _line);
+
+  template <typename Traits, typename T1, typename T2, typename D>
+  static VIR_COLD void printUlpFailure(cold_arg<T1> a, cold_arg<T2> b, const char *_a,
+                                       const char *_b, const char *_file, int _line,
+                                       cold_arg<D> allowed_distance, const char *unit);
 
-  // printFpDiff {{{2
   template <typename T1, typename T2>
-  typename std::enable_if<
-      std::is_floating_point<typename std::common_type<T1, T2>::type>::value, bool>::type
-  printFpDiff(const T1 &a, const T2 &b, int)
+  static VIR_COLD void printMemFailure(const T1 &valueA, const T2 &valueB,
+                                       const char *variableNameA,
+                                       const char *variableNameB, const char *filename,
+                                       int line);
+
+  static VIR_COLD void printMemRangeFailure(const unsigned char *a,
+                                            const unsigned char *b, std::size_t size,
+                                            const char *_a, const char *_b,
+                                            const char *_n, const char *_file, int _line);
+
+  template <typename T, typename ET>
+  static VIR_COLD void printAbsoluteErrorFailure(cold_arg<T> a, cold_arg<T> b,
+                                                 const char *_a, const char *_b,
+                                                 const char *_file, int _line,
+                                                 cold_arg<ET> error);
+
+  template <typename T, typename ET>
+  static VIR_COLD void printRelativeErrorFailure(cold_arg<T> a, cold_arg<T> b,
+                                                 const char *_a, const char *_b,
+                                                 const char *_file, int _line,
+                                                 cold_arg<ET> error);
+
+  static VIR_COLD void printVerifyFailure(const char *cond, const char *_file, int _line)
   {
-    print(") Δ=");
-    print(a - b);
-    return true;
+    printFirst();
+    printPosition(_file, _line, callerIp());
+    print(cond);
+    print(' ');
+  }
+
+  template <typename... Ts> static VIR_COLD void printAll(const Ts &... xs)
+  {
+    [[maybe_unused]] int tmp[] = {0, (print(xs), 0)...};
   }
 
+  template <typename Traits, typename T1, typename T2, typename... Ts>
+  VIR_NEVER_INLINE static void writePlotData(const T1 &a, const T2 &b, Ts &&... extra_data)
+  {
+    global_unit_test_object_.plotFile << Traits::to_datafile_string(
+        b, Traits::ulp_distance_signed(a, b), static_cast<Ts &&>(extra_data)...);
+  }
+
+  // comparisonResult {{{2
+  // floating-point comparisons print the difference, all others the result of ==
   template <typename T1, typename T2>
-  constexpr bool printFpDiff(const T1 &, const T2 &, float)
+  static auto comparisonResult(const T1 &a, const T2 &b, int) -> typename std::enable_if<
+      std::is_floating_point<typename std::common_type<T1, T2>::type>::value,
+      decltype(a - b)>::type
   {
-    return false;
+    return a - b;
+  }
+  template <typename T1, typename T2>
+  static auto comparisonResult(const T1 &a, const T2 &b, float) -> decltype(a == b)
+  {
+    return a == b;
+  }
+  template <typename T1, typename T2>
+  static constexpr typename std::enable_if<
+      std::is_floating_point<typename std::common_type<T1, T2>::type>::value,
+      const char *>::type
+  comparisonFormat(const T1 &, const T2 &, int)
+  {
+    return " Δ=%%";
+  }
+  template <typename T1, typename T2>
+  static constexpr const char *comparisonFormat(const T1 &, const T2 &, float)
+  {
+    return " -> %%";
+  }
+
+  // out {{{2
+  static std::ostream &out()
+  {
+    if (VIR_IS_UNLIKELY(quiet_checks())) {
+      static thread_local std::ostream null_stream(nullptr);
+      return null_stream;
+    }
+    return failure_buffer();  // printed by printLast
   }
 
   // printFirst {{{2
   static void printFirst()
   {
     if (!global_unit_test_object_.vim_lines) {
-      std::cout << failString() << "┍ ";
+      out() << failString() << "┍ ";
     }
   }
-  // print overloads {{{2
+  // format / formatTo {{{2
+  struct mem_ref {
+    const unsigned char *bytes;
+    std::size_t size;
+  };
+  static void formatTo(std::ostream &s, const mem_ref &mem);
   template <typename T, typename = decltype(std::cout << std::declval<const T &>())>
-  static inline void printImpl(const T &x, int)
+  static inline void formatImpl(std::ostream &s, const T &x, int)
   {
-    std::cout << x;
+    s << x;
+  }
+  template <typename T> static inline void formatImpl(std::ostream &s, const T &x, ...)
+  {
+    formatTo(s, mem_ref{reinterpret_cast<const unsigned char *>(&x), sizeof(T)});
+  }
+  template <typename T> static inline void formatTo(std::ostream &s, const T &x)
+  {
+    formatImpl(s, x, int());
   }
-  template <typename T> static inline void printImpl(const T &x, ...) { printMem(x); }
-  template <typename T> static inline void print(const T &x) { printImpl(x, int()); }
-  static void print(const std::type_info &x)
+  static void formatTo(std::ostream &s, const std::type_info &x)
   {
 #ifdef HAVE_CXX_ABI_H
     char buf[1024];
     size_t size = 1024;
     abi::__cxa_demangle(x.name(), buf, &size, nullptr);
-    std::cout << buf;
+    s << buf;
 #else
-    std::cout << x.name();
+    s << x.name();
 #endif
   }
+  static void formatTo(std::ostream &s, const unsigned char ch) { s << int(ch); }
+  static void formatTo(std::ostream &s, const signed char ch) { s << int(ch); }
+  static void formatTo(std::ostream &s, bool b) { s << (b ? "true" : "false"); }
+#ifdef __cpp_lib_experimental_parallel_simd
+  template <class T, class A>
+  static void formatTo(std::ostream &s, const std::experimental::simd<T, A> &x)
+  {
+    s << '[';
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      if (i > 0) {
+        s << ", ";
+      }
+      formatTo(s, T(x[i]));
+    }
+    s << ']';
+  }
+  template <class T, class A>
+  static void formatTo(std::ostream &s, const std::experimental::simd_mask<T, A> &k)
+  {
+    s << '[';
+    for (std::size_t i = 0; i < k.size(); ++i) {
+      s << (i > 0 ? ", " : "") << (k[i] ? '1' : '0');
+    }
+    s << ']';
+  }
+#endif  // __cpp_lib_experimental_parallel_simd
+  // print overloads {{{2
+  template <typename T> static inline void print(const T &x) { formatTo(out(), x); }
   static void print(const std::string &str) { print(str.c_str()); }
   static void print(const char *str)
   {
     const char *pos = 0;
     if (0 != (pos = std::strchr(str, '\n'))) {
       if (pos == str) {
-        std::cout << '\n' << failString();
+        out() << '\n' << failString();
         if (!global_unit_test_object_.vim_lines) {
-          std::cout << "│ ";
+          out() << "│ ";
         }
         print(&str[1]);
       } else {
         const std::string left(str, pos - str);
-        std::cout << left << '\n' << failString();
+        out() << left << '\n' << failString();
         if (!global_unit_test_object_.vim_lines) {
-          std::cout << "│ ";
+          out() << "│ ";
         }
         print(&pos[1]);
       }
     } else {
-      std::cout << str;
+      out() << str;
     }
   }
-  static void print(const unsigned char ch) { std::cout << int(ch); }
-  static void print(const signed char ch) { std::cout << int(ch); }
   static void print(const char ch)
   {
     if (ch == '\n') {
-      std::cout << '\n' << failString();
+      out() << '\n' << failString();
       if (!global_unit_test_object_.vim_lines) {
-        std::cout << "│ ";
+        out() << "│ ";
       }
     } else {
-      std::cout << ch;
+      out() << ch;
     }
   }
-  static void print(bool b) { std::cout << (b ? "true" : "false"); }
-  // printLast {{{2
-  static void printLast()
+  // mismatchedLanes {{{2
+  template <class T> static type_erased mismatchedLanes(const T &) { return {}; }
+#ifdef __cpp_lib_experimental_parallel_simd
+  template <class M> static void formatMismatchedLanes(std::ostream &s, const void *x)
   {
-    std::cout << std::endl;
-    global_unit_test_object_.status = false;
-    throw UnitTestFailure();
+    const M &ok = *static_cast<const M *>(x);
+    s << "\nmismatched lanes: " << mismatched_lanes(ok) << " (" << popcount(!ok) << " of "
+      << ok.size() << ')';
+  }
+  template <class T, class A>
+  static type_erased mismatchedLanes(const std::experimental::simd_mask<T, A> &ok)
+  {
+    return {&ok, &formatMismatchedLanes<std::experimental::simd_mask<T, A>>};
+  }
+#endif  // __cpp_lib_experimental_parallel_simd
+  template <class D, class E>
+  static auto withinTolerance(const D &ulp, const E &allowed, int)
+      -> decltype(ulp <= allowed)
+  {
+    return ulp <= allowed;
+  }
+  template <class D, class E> static bool withinTolerance(const D &, const E &, float)
+  {
+    return true;
   }
+  // printLast {{{2
+  static void printLast();
   // printPosition {{{2
-  void printPosition(const char *_file, int _line)
+  static void printPosition(const char *_file, int _line, size_t ip)
   {
+    vir::detail::watchdog::record_failed_check(_file, _line);
     if (global_unit_test_object_.vim_lines) {
-      std::cout << _file << ':' << _line << ": (0x" << std::hex << m_ip << std::dec
+      out() << _file << ':' << _line << ": (0x" << std::hex << ip << std::dec
                 << "): ";
     } else {
-      std::cout << "at " << _file << ':' << _line << " (0x" << std::hex << m_ip
+      out() << "at " << _file << ':' << _line << " (0x" << std::hex << ip
                 << std::dec << ')';
       print("):\n");
     }
   }
 
   // member variables {{{2
-  const size_t m_ip;
   const bool m_failed;
 };
 
-  // printFailure {{{2
+// cold failure paths {{{1
+template <typename T1, typename T2>
+void Compare::printFailure(cold_arg<T1> a, cold_arg<T2> b, const char *_a, const char *_b,
+                           const char *_file, int _line)
+{
+  const auto equal = a == b;
+  const auto result = comparisonResult(a, b, int());
+  reportFailure({_file, _line, callerIp(), _a, "==", _b, eraseType(a), eraseType(b),
+                 comparisonFormat(a, b, int()), {eraseType(result), mismatchedLanes(equal)}});
+}
+
+template <typename Traits, typename T1, typename T2, typename D>
+void Compare::printUlpFailure(cold_arg<T1> a, cold_arg<T2> b, const char *_a,
+                              const char *_b, const char *_file, int _line,
+                              cold_arg<D> allowed_distance, const char *unit)
+{
+  const auto equal = a == b;
+  const auto distance = Traits::ulp_distance_signed(a, b);
+  const auto within = withinTolerance(Traits::ulp_distance(a, b), allowed_distance, int());
+  reportFailure({_file, _line, callerIp(), _a, "≈", _b, eraseType(a), eraseType(b),
+                 " -> %\ndistance: % ulp, allowed distance: ±%%%",
+                 {eraseType(equal), eraseType(distance), eraseType(allowed_distance),
+                  eraseType(unit), mismatchedLanes(within)}});
+}
+
 template <typename T1, typename T2>
-VIR_NEVER_INLINE void Compare::printFailure(const T1 &a, const T2 &b, const char *_a,
-                                            const char *_b, const char *_file, int _line)
+void Compare::printMemFailure(const T1 &valueA, const T2 &valueB, const char *variableNameA,
+                              const char *variableNameB, const char *filename, int line)
+{
+  const int endian_test = 1;
+  const char *endian =
+      reinterpret_cast<const char *>(&endian_test)[0] == 1 ? "little" : "big";
+  const mem_ref memA = {reinterpret_cast<const unsigned char *>(&valueA), sizeof(T1)};
+  const mem_ref memB = {reinterpret_cast<const unsigned char *>(&valueB), sizeof(T2)};
+  reportFailure({filename, line, callerIp(), nullptr, nullptr, nullptr, {}, {},
+                 "MEMCOMPARE(%, %), memory contents (%-endian):\n%\n%",
+                 {eraseType(variableNameA), eraseType(variableNameB), eraseType(endian),
+                  eraseType(memA), eraseType(memB)}});
+}
+
+#ifndef VIR_TEST_DECLARATIONS_ONLY
+void Compare::printLast()
+{
+  out() << '\n';
+  if (quiet_checks()) {
+    throw UnitTestFailure();
+  }
+  auto &buffer = failure_buffer();
+  {
+    std::lock_guard<std::mutex> lock(report_mutex());
+    std::cout << buffer.str() << std::flush;
+  }
+  buffer.str(std::string());
+  auto &tester = global_unit_test_object_;
+  tester.status = false;
+  ++tester.failed_checks;
+  if (!tester.on_test_thread() && !checked_thread()) {
+    return;  // on a std::thread an exception would call std::terminate
+  }
+  if ((soft_check_depth() > 0 || tester.soft_checks) &&
+      tester.failed_checks < tester.max_failures) {
+    return;  // EXPECT_* or soft_checks(): continue with the test
+  }
+  throw UnitTestFailure();
+}
+
+void Compare::reportFailure(const failure_report &r)
 {
   printFirst();
-  printPosition(_file, _line);
-  print(_a);
-  print(" (");
-  print(std::setprecision(10));
-  print(a);
-  print(") == ");
-  print(_b);
-  print(" (");
-  print(std::setprecision(10));
-  print(b);
-  print(std::setprecision(6));
-  if (!printFpDiff(a, b, int())) {
-    print(") -> ");
-    print(a == b);
+  printPosition(r.file, r.line, r.ip);
+  std::ostringstream s;
+  if (r.name_a) {
+    s.precision(10);
+    s << r.name_a << " (";
+    r.value_a.format(s, r.value_a.value);
+    s << ") " << r.op << ' ' << r.name_b << " (";
+    r.value_b.format(s, r.value_b.value);
+    s << ')';
+    s.precision(6);
   }
+  auto arg = r.args.begin();
+  for (const char *c = r.details; *c; ++c) {
+    if (*c != '%' || arg == r.args.end()) {
+      s << *c;
+    } else if ((arg++)->format) {
+      (arg - 1)->format(s, (arg - 1)->value);
+    }
+  }
+  print(s.str());
   print(' ');
 }
 
+void Compare::formatTo(std::ostream &s, const mem_ref &mem)
+{
+  s << "0x";
+  for (std::size_t i = 0; i < mem.size; ++i) {
+    if (i > 0 && i % 4 == 0) {
+      s << '\'';
+    }
+    s << hexChar(mem.bytes[i] >> 4) << hexChar(mem.bytes[i] & 0xf);
+  }
+}
+
+/**\internal
+ * Prints the number of differing bytes and, for the first few differences, the 16-byte
+ * aligned rows of both buffers containing them.
+ */
+void Compare::printMemRangeFailure(const unsigned char *a, const unsigned char *b,
+                                   std::size_t size, const char *_a, const char *_b,
+                                   const char *_n, const char *_file, int _line)
+{
+  constexpr std::size_t max_windows = 4;
+  constexpr std::size_t row = 16;
+  const std::size_t first = vir::detail::first_mismatch(a, b, size);
+  const std::size_t count = vir::detail::count_mismatches(a, b, size);
+  const auto offset = [](std::size_t x) {
+    std::ostringstream s;
+    s << "0x" << std::hex << std::setw(8) << std::setfill('0') << x;
+    return s.str();
+  };
+  printFirst();
+  printPosition(_file, _line, callerIp());
+  out() << "MEMCOMPARE_RANGE(" << _a << ", " << _b << ", " << _n << "): " << count
+        << " of " << size << " bytes differ, first at offset " << offset(first);
+  const auto hex = [](const unsigned char *p, std::size_t n) {
+    std::string s;
+    for (std::size_t i = 0; i < n; ++i) {
+      s += i == row / 2 ? "  " : " ";
+      s += hexChar(p[i] >> 4);
+      s += hexChar(p[i] & 0xf);
+    }
+    return s;
+  };
+  std::size_t diff = first;
+  for (std::size_t windows = 0; diff < size && windows < max_windows; ++windows) {
+    const std::size_t begin = diff / row * row;
+    const std::size_t n = std::min(row, size - begin);
+    std::string marks;
+    for (std::size_t i = 0; i < n; ++i) {
+      marks += i == row / 2 ? "  " : " ";
+      marks += a[begin + i] == b[begin + i] ? "  " : "^^";
+    }
+    marks.erase(marks.find_last_not_of(' ') + 1);
+    const std::string indent(offset(begin).size(), ' ');
+    print("\n");
+    out() << offset(begin) << " a:" << hex(a + begin, n);
+    print("\n");
+    out() << indent << " b:" << hex(b + begin, n);
+    print("\n");
+    out() << indent << "   " << marks;
+    diff = vir::detail::first_mismatch(a, b, size, begin + n);
+  }
+  if (diff < size) {
+    print("\nfurther differences not shown");
+  }
+  print(' ');
+}
+#endif  // VIR_TEST_DECLARATIONS_ONLY
+
+template <typename T, typename ET>
+void Compare::printAbsoluteErrorFailure(cold_arg<T> a, cold_arg<T> b, const char *_a,
+                                        const char *_b, const char *_file, int _line,
+                                        cold_arg<ET> error)
+{
+  using vir::detail::ulpDiffToReferenceSigned;
+  const auto equal = a == b;
+  const char *sign = a > b ? "" : "-";
+  const auto difference = a > b ? a - b : b - a;
+  const auto distance = ulpDiffToReferenceSigned(a, b);
+  reportFailure({_file, _line, callerIp(), _a, "≈", _b, eraseType(a), eraseType(b),
+                 " -> %\ndifference: %%, allowed difference: ±%\ndistance: % ulp",
+                 {eraseType(equal), eraseType(sign), eraseType(difference),
+                  eraseType(error), eraseType(distance)}});
+}
+
+template <typename T, typename ET>
+void Compare::printRelativeErrorFailure(cold_arg<T> a, cold_arg<T> b, const char *_a,
+                                        const char *_b, const char *_file, int _line,
+                                        cold_arg<ET> error)
+{
+  using vir::detail::ulpDiffToReferenceSigned;
+  const auto equal = a == b;
+  const char *sign = a > b ? "" : "-";
+  const auto difference = a > b ? a - b : b - a;
+  const auto relative = difference / (b > 0 ? b : -b);
+  const auto allowed = error * (b > 0 ? b : -b);
+  const auto distance = ulpDiffToReferenceSigned(a, b);
+  reportFailure({_file, _line, callerIp(), _a, "≈", _b, eraseType(a), eraseType(b),
+                 " -> %\nrelative difference: %%, allowed: ±%\nabsolute difference: %%, "
+                 "allowed: ±%\ndistance: % ulp",
+                 {eraseType(equal), eraseType(sign), eraseType(relative),
+                  eraseType(error), eraseType(sign), eraseType(difference),
+                  eraseType(allowed), eraseType(distance)}});
+}
+
 // PrintMemDecorator{{{1
 template <typename T> struct PrintMemDecorator {
   T x;
@@ -980,7 +1884,28 @@ struct TestData {
   TestFunction f;
   std::string name;
 };
+#ifdef VIR_TEST_LIBRARY
+std::vector<TestData> &test_registry();
+std::vector<TestData> &benchmark_registry();
+VIR_TEST_SHARED_REF std::vector<TestData> &allTests = test_registry();
+VIR_TEST_SHARED_REF std::vector<TestData> &allBenchmarks =
+    benchmark_registry();  // only with --bench
+#ifndef VIR_TEST_DECLARATIONS_ONLY
+std::vector<TestData> &test_registry()
+{
+  static std::vector<TestData> tests;
+  return tests;
+}
+std::vector<TestData> &benchmark_registry()
+{
+  static std::vector<TestData> benchmarks;
+  return benchmarks;
+}
+#endif
+#else
 std::vector<TestData> allTests;
+std::vector<TestData> allBenchmarks;  // only run with --bench
+#endif
 
 // class Test {{{1
 template <typename TestWrapper, typename Exception = void>
@@ -1007,12 +1932,13 @@ template <typename TestWrapper> struct Test<TestWrapper, void> : public TestWrap
 
 // addTestInstantiations {{{1
 template <template <typename> class TestWrapper, typename... Ts>
-static int addTestInstantiations(const char *basename, Typelist<Ts...>)
+inline int addTestInstantiations(const char *basename, Typelist<Ts...>,
+                                 std::vector<TestData> &tests = allTests)
 {
   std::string name(basename);
   name += '<';
   const auto &x = {
-      0, (allTests.emplace_back(&TestWrapper<Ts>::run, name + typeToString<Ts>() + '>'),
+      0, (tests.emplace_back(&TestWrapper<Ts>::run, name + typeToString<Ts>() + '>'),
           0)...};
   [](decltype(x)) {}(x);  // silence "x is unused" warning
   return 0;
@@ -1037,45 +1963,10 @@ inline void setFuzzyness(T fuzz)
 // asBytes{{{1
 template <typename T> detail::PrintMemDecorator<T> asBytes(const T &x) { return {x}; }
 
-// ULP_COMPARE {{{1
-#define ULP_COMPARE(a, b, allowed_distance)                                              \
-  vir::test::detail::Compare(a, b, #a, #b, __FILE__, __LINE__,                           \
-                             vir::test::detail::Compare::Fuzzy2(), allowed_distance)
-
-// FUZZY_COMPARE {{{1
-#define FUZZY_COMPARE(a, b)                                                              \
-  vir::test::detail::Compare(a, b, #a, #b, __FILE__, __LINE__,                           \
-                             vir::test::detail::Compare::Fuzzy())
-#define FUZZY_COMPARE_WITH_EXTRA_COLUMNS(a, b, ...)                                      \
-  vir::test::detail::Compare(a, b, #a, #b, __FILE__, __LINE__,                           \
-                             vir::test::detail::Compare::Fuzzy(), __VA_ARGS__)
-// COMPARE_ABSOLUTE_ERROR {{{1
-#define COMPARE_ABSOLUTE_ERROR(a_, b_, error_)                                           \
-  vir::test::detail::Compare(a_, b_, #a_, #b_, __FILE__, __LINE__,                       \
-                             vir::test::detail::Compare::AbsoluteError(), error_)
-// COMPARE_RELATIVE_ERROR {{{1
-#define COMPARE_RELATIVE_ERROR(a_, b_, error_)                                           \
-  vir::test::detail::Compare(a_, b_, #a_, #b_, __FILE__, __LINE__,                       \
-                             vir::test::detail::Compare::RelativeError(), error_)
-// COMPARE {{{1
-#define COMPARE(a, b) vir::test::detail::Compare(a, b, #a, #b, __FILE__, __LINE__)
-// COMPARE_TYPES {{{1
+// COMPARE_TYPES helpers {{{1
 template <class T> struct type {};
 template <class T1, class T2> using type1_t = type<T1>;
 template <class T1, class T2> using type2_t = type<T2>;
-#define COMPARE_TYPES(...)                                                              \
-  vir::test::detail::Compare(std::is_same<__VA_ARGS__>::value,                                  \
-                             "is_same_v<" #__VA_ARGS__ "> -> false", __FILE__, __LINE__)   \
-      .on_failure("\n left type: ", typeid(vir::test::type1_t<__VA_ARGS__>),                       \
-                  "\nright type: ", typeid(vir::test::type2_t<__VA_ARGS__>))
-// MEMCOMPARE {{{1
-#define MEMCOMPARE(a, b)                                                                 \
-  vir::test::detail::Compare(a, b, #a, #b, __FILE__, __LINE__,                           \
-                             vir::test::detail::Compare::Mem())
-// VERIFY {{{1
-#define VERIFY(cond) vir::test::detail::Compare(cond, #cond, __FILE__, __LINE__)
-// FAIL {{{1
-#define FAIL() vir::test::detail::Compare(__FILE__, __LINE__)
 
 // SKIP {{{1
 class SKIP
@@ -1109,6 +2000,113 @@ struct ADD_PASS
   }
 };
 
+// set_timeout {{{1
+/**
+ * Overrides the --timeout for the current test: the test fails if it does not finish
+ * within \p seconds from this call. No effect without --timeout, because only tests in a
+ * child process can be stopped.
+ */
+inline void set_timeout(double seconds)
+{
+  vir::detail::watchdog::set_deadline(seconds);
+}
+
+// soft_checks {{{1
+/**
+ * Makes all failing checks of the current test non-fatal, as if they were EXPECT_*
+ * checks. The test still ends after --max-failures failed checks.
+ */
+inline void soft_checks() { detail::global_unit_test_object_.soft_checks = true; }
+
+// thread {{{1
+/**
+ * A std::thread for tests: failing checks on it end the thread (instead of calling
+ * std::terminate) and join() rethrows the failure, or any other exception the thread
+ * function threw, on the joining thread. The destructor joins a joinable thread and fails
+ * the test if the thread function threw an exception that join() did not rethrow.
+ *
+ * Checks on a plain std::thread are safe, too, but they do not end the thread; they only
+ * mark the current test as failed.
+ */
+class thread
+{
+public:
+  thread() noexcept = default;
+
+  template <class F, class... Args>
+  explicit thread(F &&f, Args &&... args)
+      : m_exception(new std::exception_ptr)
+      , m_thread(&run<typename std::decay<F>::type, typename std::decay<Args>::type...>,
+                 m_exception.get(), static_cast<F &&>(f), static_cast<Args &&>(args)...)
+  {
+  }
+
+  thread(thread &&) noexcept = default;
+  thread &operator=(thread &&) noexcept = default;
+
+  ~thread()
+  {
+    if (joinable()) {
+      m_thread.join();
+    }
+    if (m_exception && *m_exception) {
+      report_exception(*m_exception);
+    }
+  }
+
+  bool joinable() const noexcept { return m_thread.joinable(); }
+  std::thread::id get_id() const noexcept { return m_thread.get_id(); }
+
+  void join()
+  {
+    m_thread.join();
+    if (*m_exception) {
+      std::exception_ptr e = *m_exception;
+      *m_exception = nullptr;
+      std::rethrow_exception(e);
+    }
+  }
+
+private:
+  template <class F, class... Args>
+  static void run(std::exception_ptr *exception, F f, Args... args)
+  {
+    detail::checked_thread() = true;
+    try {
+      f(std::move(args)...);
+    } catch (...) {
+      *exception = std::current_exception();
+    }
+  }
+
+  /**\internal
+   * Reports an exception that was never rethrown by join() like runTestInt reports an
+   * unexpected exception of the test function. A failing check already did.
+   */
+  static void report_exception(std::exception_ptr exception) noexcept
+  {
+    auto &tester = detail::global_unit_test_object_;
+    std::lock_guard<std::mutex> lock(detail::report_mutex());
+    try {
+      std::rethrow_exception(exception);
+    } catch (const detail::UnitTestFailure &) {
+      return;
+    } catch (const std::exception &e) {
+      std::cout << detail::failString() << "┍ " << tester.test_name
+                << " threw an unexpected exception on a vir::test::thread:\n";
+      std::cout << detail::failString() << "│ " << e.what() << '\n';
+    } catch (...) {
+      std::cout << detail::failString() << "┍ " << tester.test_name
+                << " threw an unexpected exception, of unknown type, on a "
+                   "vir::test::thread\n";
+    }
+    tester.status = false;
+  }
+
+  std::unique_ptr<std::exception_ptr> m_exception;
+  std::thread m_thread;
+};
+
 // expect_failure {{{1
 VIR_DEPRECATED("use vir::test::expect_failure() instead")
 inline void EXPECT_FAILURE() { detail::global_unit_test_object_.expect_failure = true; }
@@ -1122,14 +2120,50 @@ template <class F> inline void expect_assert_failure(F &&f)
   detail::global_unit_test_object_.expect_assert_failure = false;
 }
 //}}}1
-static void initTest(int argc, char **argv)  //{{{1
+#ifdef VIR_TEST_DECLARATIONS_ONLY
+void initTest(int argc, char **argv);
+void runAll();
+int finalize();
+#else
+// option_value {{{1
+/**\internal
+ * Returns the value of the option \p name if argv[i] is either "<name>=<value>" or "<name>"
+ * followed by "<value>" in argv[i + 1]. Otherwise returns nullptr.
+ */
+static const char *option_value(const char *name, int argc, char **argv, int &i)
+{
+  const std::size_t len = std::strlen(name);
+  if (0 != std::strncmp(argv[i], name, len)) {
+    return nullptr;
+  } else if (argv[i][len] == '=') {
+    return argv[i] + len + 1;
+  } else if (argv[i][len] == '\0' && i + 1 < argc) {
+    return argv[++i];
+  }
+  return nullptr;
+}
+
+VIR_TEST_LINKAGE void initTest(int argc, char **argv)  //{{{1
 {
+  bool state_file_given = false;
   for (int i = 1; i < argc; ++i) {
     if (0 == std::strcmp(argv[i], "--help") || 0 == std::strcmp(argv[i], "-h")) {
       std::cout << "Usage: " << argv[0] << " [-h|--help] [--only <testname>] [-v|--vim] [-r|--roundingmodes]"
-                                           "[--maxdist] [--plotdist <plot.dat>]\n";
+                                           " [--denormal-modes]"
+                                           "[--maxdist] [--plotdist <plot.dat>] [--seed <n>]"
+                                           " [--property-cases <n>] [--bench]"
+                                           " [--bench-baseline <file>] [--bench-compare <file>]"
+                                           " [--bench-threshold <percent>]"
+                                           " [--bench-csv <file>] [--bench-reference <type>]"
+                                           " [--perf-counters <cycles,instructions,...>]"
+                                           " [--perf-output <file>] [--timeout <seconds>]"
+                                           " [--state-file <file>] [--rerun-failed]"
+                                           " [--failed-first] [--max-failures <n>]"
+                                           " [--results <file>] [--shard <index>/<count>]"
+                                           " [--sample <fraction|count>] [--list]\n";
       exit(0);
     }
+    const char *value = nullptr;
     if (0 == std::strcmp(argv[i], "--only") && i + 1 < argc) {
       detail::global_unit_test_object_.only_name = argv[i + 1];
     } else if (0 == std::strcmp(argv[i], "--maxdist")) {
@@ -1141,117 +2175,290 @@ static void initTest(int argc, char **argv)  //{{{1
       detail::global_unit_test_object_.vim_lines = true;
     } else if (0 == std::strcmp(argv[i], "--roundingmodes") || 0 == std::strcmp(argv[i], "-r")) {
       detail::global_unit_test_object_.test_roundingmodes = true;
+    } else if (0 == std::strcmp(argv[i], "--denormal-modes")) {
+      detail::global_unit_test_object_.test_denormal_modes = true;
+    } else if (0 == std::strcmp(argv[i], "--seed") && i + 1 < argc) {
+      vir::detail::global_random_state().seed = std::strtoull(argv[i + 1], nullptr, 0);
+    } else if (0 == std::strcmp(argv[i], "--list")) {
+      detail::global_unit_test_object_.list_tests = true;
+    } else if (0 == std::strcmp(argv[i], "--bench")) {
+      detail::global_unit_test_object_.run_benchmarks = true;
+    } else if (0 == std::strcmp(argv[i], "--property-cases") && i + 1 < argc) {
+      detail::global_unit_test_object_.property_cases =
+          std::strtoull(argv[i + 1], nullptr, 0);
+    } else if ((value = option_value("--bench-baseline", argc, argv, i))) {
+      detail::global_unit_test_object_.bench_baseline = value;
+      detail::global_unit_test_object_.run_benchmarks = true;
+    } else if ((value = option_value("--bench-compare", argc, argv, i))) {
+      detail::global_unit_test_object_.bench_compare = value;
+      detail::global_unit_test_object_.run_benchmarks = true;
+    } else if ((value = option_value("--bench-threshold", argc, argv, i))) {
+      detail::global_unit_test_object_.bench_threshold = std::atof(value) / 100;
+    } else if ((value = option_value("--bench-csv", argc, argv, i))) {
+      detail::global_unit_test_object_.bench_csv = value;
+      detail::global_unit_test_object_.run_benchmarks = true;
+    } else if ((value = option_value("--bench-reference", argc, argv, i))) {
+      detail::global_unit_test_object_.bench_reference = value;
+    } else if ((value = option_value("--state-file", argc, argv, i))) {
+      detail::global_unit_test_object_.state_file = value;
+      state_file_given = true;
+    } else if (0 == std::strcmp(argv[i], "--rerun-failed")) {
+      detail::global_unit_test_object_.rerun_failed = true;
+    } else if (0 == std::strcmp(argv[i], "--failed-first")) {
+      detail::global_unit_test_object_.failed_first = true;
+    } else if ((value = option_value("--results", argc, argv, i))) {
+      detail::global_unit_test_object_.resultsFile.open(value);
+      if (!detail::global_unit_test_object_.resultsFile) {
+        std::cerr << "--results: cannot open " << value << " for writing\n";
+        std::exit(1);
+      }
+      detail::global_unit_test_object_.resultsFile << vir::detail::results_header << '\n';
+    } else if ((value = option_value("--shard", argc, argv, i))) {
+      char *end = nullptr;
+      const auto index = std::strtoul(value, &end, 10);
+      const auto count = *end == '/' ? std::strtoul(end + 1, nullptr, 10) : 0;
+      if (count == 0 || index >= count) {
+        std::cerr << "--shard expects <index>/<count> with index < count\n";
+        std::exit(1);
+      }
+      detail::global_unit_test_object_.shard_index = index;
+      detail::global_unit_test_object_.shard_count = count;
+    } else if ((value = option_value("--sample", argc, argv, i))) {
+      // a fraction if written with a decimal point, otherwise a count
+      if (std::strchr(value, '.')) {
+        const double fraction = std::atof(value);
+        if (!(fraction > 0 && fraction <= 1)) {
+          std::cerr << "--sample expects a fraction in (0, 1] or a count > 0\n";
+          std::exit(1);
+        }
+        detail::global_unit_test_object_.sample_fraction = fraction;
+      } else {
+        const auto count = std::strtoul(value, nullptr, 10);
+        if (count == 0) {
+          std::cerr << "--sample expects a fraction in (0, 1] or a count > 0\n";
+          std::exit(1);
+        }
+        detail::global_unit_test_object_.sample_count = count;
+      }
+    } else if ((value = option_value("--max-failures", argc, argv, i))) {
+      detail::global_unit_test_object_.max_failures = std::max(1, std::atoi(value));
+    } else if ((value = option_value("--timeout", argc, argv, i))) {
+      detail::global_unit_test_object_.timeout = std::atof(value);
+    } else if ((value = option_value("--perf-counters", argc, argv, i))) {
+      detail::global_unit_test_object_.perfCounters.open(value);
+    } else if ((value = option_value("--perf-output", argc, argv, i))) {
+      detail::global_unit_test_object_.perfFile.open(value);
+    }
+  }
+  if (!state_file_given && (detail::global_unit_test_object_.rerun_failed ||
+                            detail::global_unit_test_object_.failed_first)) {
+    // <executable name>.last-run in the working directory, not next to the executable
+    const std::string exe = argv[0];
+    const auto slash = exe.find_last_of("/\\");
+    detail::global_unit_test_object_.state_file =
+        (slash == std::string::npos ? exe : exe.substr(slash + 1)) + ".last-run";
+  }
+  if (!detail::global_unit_test_object_.state_file.empty()) {
+    detail::global_unit_test_object_.readState();
+  }
+}
+
+namespace detail
+{
+/**\internal
+ * Applies --sample to \p all_tests: returns which tests to run. The sample is stratified
+ * by test function, i.e. every TEST and every TEST_TYPES template keeps at least one
+ * (randomly chosen) instantiation, even if that exceeds the requested size. The choice is
+ * a function of the run's seed (--seed).
+ */
+inline std::vector<bool> sampleTests(const std::vector<TestData> &all_tests)
+{
+  const std::size_t n = all_tests.size();
+  const auto &tester = global_unit_test_object_;
+  if (tester.sample_count == 0 && tester.sample_fraction == 0) {
+    return std::vector<bool>(n, true);
+  }
+  const std::size_t size =
+      tester.sample_count != 0
+          ? tester.sample_count
+          : static_cast<std::size_t>(std::ceil(tester.sample_fraction * n));
+  // "name<type>" -> "name"
+  std::map<std::string, std::vector<std::size_t>> functions;
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto &name = all_tests[i].name;
+    functions[name.substr(0, name.find('<'))].push_back(i);
+  }
+  std::uint64_t rng = vir::detail::global_random_state().seed;
+  const auto random_index = [&](std::size_t bound) {
+    return static_cast<std::size_t>(vir::detail::splitmix64(rng) % bound);
+  };
+  std::vector<bool> chosen(n, false);
+  std::vector<std::size_t> rest;
+  for (const auto &function : functions) {
+    const auto &instantiations = function.second;
+    const std::size_t pick = random_index(instantiations.size());
+    chosen[instantiations[pick]] = true;
+    for (std::size_t i = 0; i < instantiations.size(); ++i) {
+      if (i != pick) {
+        rest.push_back(instantiations[i]);
+      }
+    }
+  }
+  // fill up with a uniformly chosen subset of the remaining instantiations
+  for (std::size_t k = functions.size(), i = rest.size(); k < size && i > 0; ++k, --i) {
+    std::swap(rest[i - 1], rest[random_index(i)]);
+    chosen[rest[i - 1]] = true;
+  }
+  return chosen;
+}
+
+/**\internal
+ * Whether the state file records a failure of a test or benchmark that still exists.
+ */
+inline bool hasRecordedFailures()
+{
+  for (const auto &entry : global_unit_test_object_.last_state) {
+    if (entry.second != "FAIL") {
+      continue;
+    }
+    for (const auto *registry : {&allTests, &allBenchmarks}) {
+      for (const auto &data : *registry) {
+        if (data.name == entry.first) {
+          return true;
+        }
+      }
     }
   }
+  return false;
 }
 
-static void runAll() //{{{1
-{
-  if (detail::global_unit_test_object_.test_roundingmodes) {
-    for (auto roundmode : {FE_TONEAREST, FE_DOWNWARD, FE_UPWARD, FE_TOWARDZERO}) {
-      std::cout << "-------- Setting rounding mode to "
-                << (roundmode == FE_TONEAREST
-                        ? "FE_TONEAREST"
-                        : roundmode == FE_DOWNWARD
-                              ? "FE_DOWNWARD"
-                              : roundmode == FE_UPWARD ? "FE_UPWARD" : "FE_TOWARDZERO")
-                << " --------\n";
-      for (const auto &data : detail::allTests) {
-        detail::global_unit_test_object_.runTestInt(data.f, data.name.c_str());
+/**\internal
+ * Applies --sample (if \p sample), --shard, --rerun-failed, and --failed-first to
+ * \p all_tests. Without recorded failures of registered tests all tests of the shard are
+ * selected.
+ */
+inline std::vector<const TestData *> selectTests(const std::vector<TestData> &all_tests,
+                                                 bool sample = false)
+{
+  const std::vector<bool> sampled =
+      sample ? sampleTests(all_tests) : std::vector<bool>(all_tests.size(), true);
+  // --shard: every shard_count-th test in registration order
+  std::vector<const TestData *> tests;
+  for (std::size_t i = 0; i < all_tests.size(); ++i) {
+    if (sampled[i] &&
+        i % global_unit_test_object_.shard_count == global_unit_test_object_.shard_index) {
+      tests.push_back(&all_tests[i]);
+    }
+  }
+  const auto &last = global_unit_test_object_.last_state;
+  std::vector<const TestData *> failed, rest;
+  for (const auto data : tests) {
+    const auto it = last.find(data->name);
+    (it != last.end() && it->second == "FAIL" ? failed : rest).push_back(data);
+  }
+  if (global_unit_test_object_.rerun_failed && hasRecordedFailures()) {
+    return failed;
+  }
+  if (global_unit_test_object_.rerun_failed || global_unit_test_object_.failed_first) {
+    failed.insert(failed.end(), rest.begin(), rest.end());
+    return failed;
+  }
+  return tests;
+}
+}  // namespace detail
+
+VIR_TEST_LINKAGE void runAll() //{{{1
+{
+  const auto tests = detail::selectTests(detail::allTests, true);
+  if (detail::global_unit_test_object_.list_tests) {
+    // one name per line, each can be passed to --only
+    for (const auto data : tests) {
+      std::cout << data->name << '\n';
+    }
+    if (detail::global_unit_test_object_.run_benchmarks) {
+      for (const auto data : detail::selectTests(detail::allBenchmarks)) {
+        std::cout << data->name << '\n';
       }
     }
-    std::fesetround(FE_TONEAREST);
+    std::cout.flush();
+    std::exit(0);
+  }
+  auto &tester = detail::global_unit_test_object_;
+  if (tester.sample_count != 0 || tester.sample_fraction != 0) {
+    const auto seed = vir::detail::global_random_state().seed;
+    const auto sampled = detail::sampleTests(detail::allTests);
+    std::cout << "-------- Sampled " << std::count(sampled.begin(), sampled.end(), true)
+              << " of " << sampled.size() << " tests (seed " << seed
+              << ", replay with --seed " << seed << ") --------\n";
+  }
+  const auto run_tests = [&]() {
+    if (tester.test_roundingmodes) {
+      for (auto roundmode : {FE_TONEAREST, FE_DOWNWARD, FE_UPWARD, FE_TOWARDZERO}) {
+        std::cout << "-------- Setting rounding mode to "
+                  << (roundmode == FE_TONEAREST
+                          ? "FE_TONEAREST"
+                          : roundmode == FE_DOWNWARD
+                                ? "FE_DOWNWARD"
+                                : roundmode == FE_UPWARD ? "FE_UPWARD" : "FE_TOWARDZERO")
+                  << " --------\n";
+        for (const auto data : tests) {
+          tester.runTest(data->f, data->name.c_str());
+        }
+      }
+      std::fesetround(FE_TONEAREST);
+    } else {
+      for (const auto data : tests) {
+        tester.runTest(data->f, data->name.c_str());
+      }
+    }
+  };
+  if (tester.test_denormal_modes) {
+    using vir::detail::denormal_mode;
+    for (auto mode : {denormal_mode::ieee, denormal_mode::ftz, denormal_mode::daz,
+                      denormal_mode::ftz_daz}) {
+      const char *name = vir::detail::denormal_mode_name(mode);
+      if (!vir::detail::denormal_mode_supported(mode)) {
+        std::cout << "-------- Denormal mode " << name << " is not supported --------\n";
+        continue;
+      }
+      std::cout << "-------- Setting denormal mode to " << name << " --------\n";
+      const int passed = tester.passedTests;
+      const int failed = tester.failedTestCount();
+      const int skipped = tester.skippedTests;
+      {
+        const vir::detail::denormal_mode_guard guard(mode);
+        run_tests();
+      }
+      std::cout << "-------- " << name << ": " << tester.passedTests - passed
+                << " passed, " << tester.failedTestCount() - failed << " failed, "
+                << tester.skippedTests - skipped << " skipped --------\n";
+    }
   } else {
-    for (const auto &data : detail::allTests) {
-      detail::global_unit_test_object_.runTestInt(data.f, data.name.c_str());
+    run_tests();
+  }
+  if (detail::global_unit_test_object_.run_benchmarks) {
+    for (const auto data : detail::selectTests(detail::allBenchmarks)) {
+      detail::global_unit_test_object_.runTestInt(data->f, data->name.c_str());
+    }
+    if (detail::global_unit_test_object_.bench_report) {
+      detail::global_unit_test_object_.bench_report();
     }
   }
 }
 
-static int finalize()  //{{{1
+VIR_TEST_LINKAGE int finalize()  //{{{1
 {
   return detail::global_unit_test_object_.finalize();
 }
+#endif  // VIR_TEST_DECLARATIONS_ONLY
 
 //}}}1
 }  // namespace test
 }  // namespace vir
 
-// TEST_TYPES / TEST_CATCH / TEST macros {{{1
-namespace Tests
-{
-using namespace vir::test;
-}
-
-#define REAL_TEST_TYPES(T_, name_, ...)                                                  \
-  namespace Tests                                                                        \
-  {                                                                                      \
-  template <typename T_> struct name_##_ {                                               \
-    static void run();                                                                   \
-  };                                                                                     \
-  static struct name_##_ctor {                                                           \
-    name_##_ctor()                                                                       \
-    {                                                                                    \
-      using vir::Typelist;                                                               \
-      using vir::concat;                                                                 \
-      using vir::outer_product;                                                          \
-      using list = vir::ensure_typelist_t<__VA_ARGS__>;                                  \
-      vir::test::detail::addTestInstantiations<name_##_>(#name_, list{});                \
-    }                                                                                    \
-  } name_##_ctor_;                                                                       \
-  }                                                                                      \
-  template <typename T_> void Tests::name_##_<T_>::run()
-
-#define FAKE_TEST_TYPES(V_, name_, ...)                                                  \
-  namespace Tests                                                                        \
-  {                                                                                      \
-  template <typename V_> struct name_##_ {                                               \
-    static void run();                                                                   \
-  };                                                                                     \
-  }                                                                                      \
-  template <typename V_> void Tests::name_##_<V_>::run()
-
-#define REAL_TEST(name_)                                                                 \
-  namespace Tests                                                                        \
-  {                                                                                      \
-  struct name_##_ {                                                                      \
-    static void run();                                                                   \
-  };                                                                                     \
-  vir::test::detail::Test<name_##_> test_##name_##_(#name_);                             \
-  }                                                                                      \
-  void Tests::name_##_::run()
-
-#define FAKE_TEST(name_) template <typename UnitTest_T_> void name_##_()
-
-#define REAL_TEST_CATCH(name_, exception_)                                               \
-  struct Test##name_ {                                                                   \
-    static void run();                                                                   \
-  };                                                                                     \
-  vir::test::detail::Test<Test##name_, exception_> test_##name_##_(#name_);              \
-  void Test##name_::run()
-
-#define FAKE_TEST_CATCH(name_, exception_) template <typename UnitTesT_T_> void name_()
-
-#ifdef UNITTEST_ONLY_XTEST
-#define TEST_TYPES(V_, name_, ...) FAKE_TEST_TYPES(V_, name_, __VA_ARGS__)
-#define XTEST_TYPES(V_, name_, ...) REAL_TEST_TYPES(V_, name_, __VA_ARGS__)
-
-#define TEST(name_) FAKE_TEST(name_)
-#define XTEST(name_) REAL_TEST(name_)
-
-#define TEST_CATCH(name_, exception_) FAKE_TEST_CATCH(name_, exception_)
-#define XTEST_CATCH(name_, exception_) REAL_TEST_CATCH(name_, exception_)
-#else
-#define XTEST_TYPES(V_, name_, ...) FAKE_TEST_TYPES(V_, name_, __VA_ARGS__)
-#define TEST_TYPES(V_, name_, ...) REAL_TEST_TYPES(V_, name_, __VA_ARGS__)
-
-#define XTEST(name_) FAKE_TEST(name_)
-#define TEST(name_) REAL_TEST(name_)
-
-#define XTEST_CATCH(name_, exception_) FAKE_TEST_CATCH(name_, exception_)
-#define TEST_CATCH(name_, exception_) REAL_TEST_CATCH(name_, exception_)
-#endif
+#include "test_macros.h"
 
+#ifndef VIR_TEST_DECLARATIONS_ONLY
 int
 #ifdef _MSC_VER
 __cdecl
@@ -1262,6 +2469,7 @@ main(int argc, char **argv)  //{{{1
   vir::test::runAll();
   return vir::test::finalize();
 }
+#endif  // VIR_TEST_DECLARATIONS_ONLY
 
 //}}}1
 #endif  // VIR_TEST_H_
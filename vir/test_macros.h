@@ -0,0 +1,191 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+
+#ifndef VIR_TEST_MACROS_H_
+#define VIR_TEST_MACROS_H_
+
+// The check and test registration macros. vir/test.h includes this header. Code that
+// uses `import vir.test;` instead includes only this header after the import.
+
+#include <type_traits>
+#include <typeinfo>
+
+#ifndef VIR_CHECK_HIT_
+// check hit counting requires the header vir/test.h (see detail/check_hits.h)
+#define VIR_CHECK_HIT_(expression_)
+#endif
+
+// ULP_COMPARE {{{1
+#define ULP_COMPARE(a, b, allowed_distance)                                              \
+  (VIR_CHECK_HIT_("ULP_COMPARE(" #a ", " #b ", " #allowed_distance ")")                  \
+   vir::test::detail::Compare(a, b, #a, #b, __FILE__, __LINE__,                          \
+                              vir::test::detail::Compare::Fuzzy2(), allowed_distance))
+
+// FUZZY_COMPARE {{{1
+#define FUZZY_COMPARE(a, b)                                                              \
+  (VIR_CHECK_HIT_("FUZZY_COMPARE(" #a ", " #b ")")                                       \
+   vir::test::detail::Compare(a, b, #a, #b, __FILE__, __LINE__,                          \
+                              vir::test::detail::Compare::Fuzzy()))
+#define FUZZY_COMPARE_WITH_EXTRA_COLUMNS(a, b, ...)                                      \
+  (VIR_CHECK_HIT_("FUZZY_COMPARE(" #a ", " #b ")")                                       \
+   vir::test::detail::Compare(a, b, #a, #b, __FILE__, __LINE__,                          \
+                              vir::test::detail::Compare::Fuzzy(), __VA_ARGS__))
+// COMPARE_ABSOLUTE_ERROR {{{1
+#define COMPARE_ABSOLUTE_ERROR(a_, b_, error_)                                           \
+  (VIR_CHECK_HIT_("COMPARE_ABSOLUTE_ERROR(" #a_ ", " #b_ ", " #error_ ")")               \
+   vir::test::detail::Compare(a_, b_, #a_, #b_, __FILE__, __LINE__,                      \
+                              vir::test::detail::Compare::AbsoluteError(), error_))
+// COMPARE_RELATIVE_ERROR {{{1
+#define COMPARE_RELATIVE_ERROR(a_, b_, error_)                                           \
+  (VIR_CHECK_HIT_("COMPARE_RELATIVE_ERROR(" #a_ ", " #b_ ", " #error_ ")")               \
+   vir::test::detail::Compare(a_, b_, #a_, #b_, __FILE__, __LINE__,                      \
+                              vir::test::detail::Compare::RelativeError(), error_))
+// COMPARE {{{1
+#define COMPARE(a, b)                                                                    \
+  (VIR_CHECK_HIT_("COMPARE(" #a ", " #b ")")                                             \
+   vir::test::detail::Compare(a, b, #a, #b, __FILE__, __LINE__))
+// COMPARE_TYPES {{{1
+#define COMPARE_TYPES(...)                                                              \
+  (VIR_CHECK_HIT_("COMPARE_TYPES(" #__VA_ARGS__ ")")                                    \
+   vir::test::detail::Compare(std::is_same<__VA_ARGS__>::value,                                 \
+                             "is_same_v<" #__VA_ARGS__ "> -> false", __FILE__, __LINE__))  \
+      .on_failure("\n left type: ", typeid(vir::test::type1_t<__VA_ARGS__>),                       \
+                  "\nright type: ", typeid(vir::test::type2_t<__VA_ARGS__>))
+// MEMCOMPARE {{{1
+#define MEMCOMPARE(a, b)                                                                 \
+  (VIR_CHECK_HIT_("MEMCOMPARE(" #a ", " #b ")")                                          \
+   vir::test::detail::Compare(a, b, #a, #b, __FILE__, __LINE__,                          \
+                              vir::test::detail::Compare::Mem()))
+// MEMCOMPARE_RANGE {{{1
+/**
+ * Compares the \p n objects at \p a and \p b byte by byte. On failure only the number of
+ * differing bytes and hex dumps of the rows around the first differences are printed.
+ */
+#define MEMCOMPARE_RANGE(a, b, n)                                                        \
+  (VIR_CHECK_HIT_("MEMCOMPARE_RANGE(" #a ", " #b ", " #n ")")                            \
+   vir::test::detail::Compare(a, b, n, #a, #b, #n, __FILE__, __LINE__,                   \
+                              vir::test::detail::Compare::MemRange()))
+// VERIFY {{{1
+#define VERIFY(cond)                                                                     \
+  (VIR_CHECK_HIT_("VERIFY(" #cond ")")                                                   \
+   vir::test::detail::Compare(cond, #cond, __FILE__, __LINE__))
+// EXPECT_* {{{1
+#define EXPECT_COMPARE(a, b) (vir::test::detail::soft_check(), COMPARE(a, b))
+#define EXPECT_FUZZY_COMPARE(a, b) (vir::test::detail::soft_check(), FUZZY_COMPARE(a, b))
+#define EXPECT_ULP_COMPARE(a, b, allowed_distance)                                       \
+  (vir::test::detail::soft_check(), ULP_COMPARE(a, b, allowed_distance))
+#define EXPECT_COMPARE_ABSOLUTE_ERROR(a_, b_, error_)                                    \
+  (vir::test::detail::soft_check(), COMPARE_ABSOLUTE_ERROR(a_, b_, error_))
+#define EXPECT_COMPARE_RELATIVE_ERROR(a_, b_, error_)                                    \
+  (vir::test::detail::soft_check(), COMPARE_RELATIVE_ERROR(a_, b_, error_))
+#define EXPECT_MEMCOMPARE(a, b) (vir::test::detail::soft_check(), MEMCOMPARE(a, b))
+#define EXPECT_MEMCOMPARE_RANGE(a, b, n)                                                 \
+  (vir::test::detail::soft_check(), MEMCOMPARE_RANGE(a, b, n))
+#define EXPECT_VERIFY(cond) (vir::test::detail::soft_check(), VERIFY(cond))
+// FAIL {{{1
+#define FAIL() vir::test::detail::Compare(__FILE__, __LINE__)
+
+// TEST_TYPES / TEST_CATCH / TEST macros {{{1
+namespace Tests
+{
+using namespace vir::test;
+}
+
+#define REAL_TEST_TYPES(T_, name_, ...)                                                  \
+  namespace Tests                                                                        \
+  {                                                                                      \
+  template <typename T_> struct name_##_ {                                               \
+    static void run();                                                                   \
+  };                                                                                     \
+  static struct name_##_ctor {                                                           \
+    name_##_ctor()                                                                       \
+    {                                                                                    \
+      using vir::Typelist;                                                               \
+      using vir::concat;                                                                 \
+      using vir::outer_product;                                                          \
+      using list = vir::ensure_typelist_t<__VA_ARGS__>;                                  \
+      vir::test::detail::addTestInstantiations<name_##_>(#name_, list{});                \
+    }                                                                                    \
+  } name_##_ctor_;                                                                       \
+  }                                                                                      \
+  template <typename T_> void Tests::name_##_<T_>::run()
+
+#define FAKE_TEST_TYPES(V_, name_, ...)                                                  \
+  namespace Tests                                                                        \
+  {                                                                                      \
+  template <typename V_> struct name_##_ {                                               \
+    static void run();                                                                   \
+  };                                                                                     \
+  }                                                                                      \
+  template <typename V_> void Tests::name_##_<V_>::run()
+
+#define REAL_TEST(name_)                                                                 \
+  namespace Tests                                                                        \
+  {                                                                                      \
+  struct name_##_ {                                                                      \
+    static void run();                                                                   \
+  };                                                                                     \
+  vir::test::detail::Test<name_##_> test_##name_##_(#name_);                             \
+  }                                                                                      \
+  void Tests::name_##_::run()
+
+#define FAKE_TEST(name_) template <typename UnitTest_T_> void name_##_()
+
+#define REAL_TEST_CATCH(name_, exception_)                                               \
+  struct Test##name_ {                                                                   \
+    static void run();                                                                   \
+  };                                                                                     \
+  vir::test::detail::Test<Test##name_, exception_> test_##name_##_(#name_);              \
+  void Test##name_::run()
+
+#define FAKE_TEST_CATCH(name_, exception_) template <typename UnitTesT_T_> void name_()
+
+#ifdef UNITTEST_ONLY_XTEST
+#define TEST_TYPES(V_, name_, ...) FAKE_TEST_TYPES(V_, name_, __VA_ARGS__)
+#define XTEST_TYPES(V_, name_, ...) REAL_TEST_TYPES(V_, name_, __VA_ARGS__)
+
+#define TEST(name_) FAKE_TEST(name_)
+#define XTEST(name_) REAL_TEST(name_)
+
+#define TEST_CATCH(name_, exception_) FAKE_TEST_CATCH(name_, exception_)
+#define XTEST_CATCH(name_, exception_) REAL_TEST_CATCH(name_, exception_)
+#else
+#define XTEST_TYPES(V_, name_, ...) FAKE_TEST_TYPES(V_, name_, __VA_ARGS__)
+#define TEST_TYPES(V_, name_, ...) REAL_TEST_TYPES(V_, name_, __VA_ARGS__)
+
+#define XTEST(name_) FAKE_TEST(name_)
+#define TEST(name_) REAL_TEST(name_)
+
+#define XTEST_CATCH(name_, exception_) FAKE_TEST_CATCH(name_, exception_)
+#define TEST_CATCH(name_, exception_) REAL_TEST_CATCH(name_, exception_)
+#endif
+
+//}}}1
+#endif  // VIR_TEST_MACROS_H_
+
+// vim: foldmethod=marker
@@ -0,0 +1,341 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+#ifndef VIR_TESTALLOC_H_
+#define VIR_TESTALLOC_H_
+
+// Replaces the global operator new/delete to count the heap allocations of every test.
+// Like test.h, this header must be included in exactly one translation unit.
+
+#include "test.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <new>
+
+namespace vir
+{
+namespace test
+{
+// allocation_stats {{{1
+struct allocation_stats {
+  std::uint64_t allocations;  // number of calls to operator new
+  std::uint64_t bytes;        // sum of the requested sizes
+  std::uint64_t peak;         // maximum of the live heap bytes, relative to the test start
+};
+
+namespace detail
+{
+// allocation counters {{{1
+struct allocation_counters {
+  std::atomic<std::uint64_t> allocations;
+  std::atomic<std::uint64_t> bytes;
+  std::atomic<std::uint64_t> live;
+  std::atomic<std::uint64_t> peak;
+  std::uint64_t live_at_start;
+};
+
+/**\internal
+ * Zero-initialized before any dynamic initialization, thus usable from operator new
+ * during static initialization.
+ */
+inline allocation_counters &alloc_counters()
+{
+  static allocation_counters counters;
+  return counters;
+}
+
+/**\internal
+ * Number of allocations of the calling thread; used by no_alloc_scope.
+ */
+inline std::uint64_t &thread_allocations()
+{
+  static thread_local std::uint64_t n = 0;
+  return n;
+}
+
+// tracked_alloc / tracked_free {{{1
+/**\internal
+ * Every allocation is prefixed with a header storing the requested size and the offset
+ * to the pointer returned from malloc.
+ */
+struct alloc_header {
+  std::size_t size;
+  std::size_t offset;
+};
+
+inline void *tracked_alloc(std::size_t size, std::size_t align) noexcept
+{
+  if (align < alignof(std::max_align_t)) {
+    align = alignof(std::max_align_t);
+  }
+  const std::size_t header = (sizeof(alloc_header) + align - 1) / align * align;
+  char *raw = static_cast<char *>(std::malloc(size + header + align - alignof(std::max_align_t)));
+  if (!raw) {
+    return nullptr;
+  }
+  const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(raw) + header;
+  char *ptr = raw + ((first + align - 1) / align * align - reinterpret_cast<std::uintptr_t>(raw));
+  alloc_header *h = reinterpret_cast<alloc_header *>(ptr) - 1;
+  h->size = size;
+  h->offset = static_cast<std::size_t>(ptr - raw);
+
+  auto &c = alloc_counters();
+  ++thread_allocations();
+  c.allocations.fetch_add(1, std::memory_order_relaxed);
+  c.bytes.fetch_add(size, std::memory_order_relaxed);
+  const std::uint64_t live = c.live.fetch_add(size, std::memory_order_relaxed) + size;
+  std::uint64_t peak = c.peak.load(std::memory_order_relaxed);
+  while (live > peak &&
+         !c.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+  return ptr;
+}
+
+inline void *tracked_new(std::size_t size, std::size_t align)
+{
+  if (size == 0) {
+    size = 1;
+  }
+  void *ptr = tracked_alloc(size, align);
+  while (!ptr) {
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) {
+      throw std::bad_alloc();
+    }
+    handler();
+    ptr = tracked_alloc(size, align);
+  }
+  return ptr;
+}
+
+// the nothrow forms also call the new_handler; only bad_alloc means failure
+inline void *tracked_new_nothrow(std::size_t size, std::size_t align) noexcept
+{
+  try {
+    return tracked_new(size, align);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+
+inline void tracked_free(void *ptr) noexcept
+{
+  if (!ptr) {
+    return;
+  }
+  const alloc_header *h = static_cast<alloc_header *>(ptr) - 1;
+  alloc_counters().live.fetch_sub(h->size, std::memory_order_relaxed);
+  std::free(static_cast<char *>(ptr) - h->offset);
+}
+
+// test hooks {{{1
+inline void reset_allocation_stats()
+{
+  auto &c = alloc_counters();
+  c.allocations.store(0, std::memory_order_relaxed);
+  c.bytes.store(0, std::memory_order_relaxed);
+  c.live_at_start = c.live.load(std::memory_order_relaxed);
+  c.peak.store(c.live_at_start, std::memory_order_relaxed);
+}
+
+}  // namespace detail
+
+/**
+ * Returns the allocations of the current test so far.
+ */
+inline allocation_stats current_allocation_stats()
+{
+  const auto &c = detail::alloc_counters();
+  const std::uint64_t peak = c.peak.load(std::memory_order_relaxed);
+  return {c.allocations.load(std::memory_order_relaxed),
+          c.bytes.load(std::memory_order_relaxed),
+          peak > c.live_at_start ? peak - c.live_at_start : 0};
+}
+
+namespace detail
+{
+inline void append_allocation_stats()
+{
+  const auto stats = current_allocation_stats();
+  std::ostringstream s;
+  s << " [" << stats.allocations << " allocations, " << stats.bytes << " bytes, peak "
+    << stats.peak << " bytes]";
+  global_unit_test_object_.test_details += s.str();
+}
+
+static struct allocation_tracking_init {
+  allocation_tracking_init()
+  {
+    global_unit_test_object_.test_started = &reset_allocation_stats;
+    global_unit_test_object_.test_finished = &append_allocation_stats;
+  }
+} allocation_tracking_init_;
+
+//}}}1
+}  // namespace detail
+
+// no_alloc_scope {{{1
+/**
+ * Fails the test if the current thread allocates between construction and destruction
+ * of this object.
+ */
+class no_alloc_scope
+{
+public:
+#ifdef __GNUC__
+  explicit no_alloc_scope(const char *file = __builtin_FILE(), int line = __builtin_LINE())
+#else
+  no_alloc_scope(const char *file, int line)
+#endif
+      : m_file(file), m_line(line), m_start(detail::thread_allocations())
+#if __cpp_lib_uncaught_exceptions
+      , m_exceptions(std::uncaught_exceptions())
+#endif
+  {
+  }
+
+  no_alloc_scope(const no_alloc_scope &) = delete;
+  no_alloc_scope &operator=(const no_alloc_scope &) = delete;
+
+  ~no_alloc_scope() noexcept(false)
+  {
+    const std::uint64_t n = detail::thread_allocations() - m_start;
+#if __cpp_lib_uncaught_exceptions
+    const bool unwinding = std::uncaught_exceptions() > m_exceptions;
+#else
+    const bool unwinding = std::uncaught_exception();
+#endif
+    if (VIR_IS_UNLIKELY(n > 0) && !unwinding) {
+      detail::Compare(m_file, m_line) << "no_alloc_scope: " << n
+                                      << (n == 1 ? " allocation" : " allocations")
+                                      << " in a region that must not allocate";
+    }
+  }
+
+private:
+  const char *const m_file;
+  const int m_line;
+  const std::uint64_t m_start;
+#if __cpp_lib_uncaught_exceptions
+  const int m_exceptions;
+#endif
+};
+
+//}}}1
+}  // namespace test
+}  // namespace vir
+
+// NO_ALLOC {{{1
+/**
+ * Evaluates the expression and fails the test if it allocated.
+ */
+#define NO_ALLOC(...)                                                                    \
+  [&]() {                                                                                \
+    vir::test::no_alloc_scope vir_no_alloc_scope_(__FILE__, __LINE__);                  \
+    return __VA_ARGS__;                                                                  \
+  }()
+
+// operator new / delete replacements {{{1
+void *operator new(std::size_t size) { return vir::test::detail::tracked_new(size, 0); }
+void *operator new[](std::size_t size) { return vir::test::detail::tracked_new(size, 0); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  return vir::test::detail::tracked_new_nothrow(size, 0);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+  return vir::test::detail::tracked_new_nothrow(size, 0);
+}
+void operator delete(void *ptr) noexcept { vir::test::detail::tracked_free(ptr); }
+void operator delete[](void *ptr) noexcept { vir::test::detail::tracked_free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+  vir::test::detail::tracked_free(ptr);
+}
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+  vir::test::detail::tracked_free(ptr);
+}
+#if __cpp_sized_deallocation
+void operator delete(void *ptr, std::size_t) noexcept { vir::test::detail::tracked_free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+  vir::test::detail::tracked_free(ptr);
+}
+#endif
+#if __cpp_aligned_new
+void *operator new(std::size_t size, std::align_val_t align)
+{
+  return vir::test::detail::tracked_new(size, static_cast<std::size_t>(align));
+}
+void *operator new[](std::size_t size, std::align_val_t align)
+{
+  return vir::test::detail::tracked_new(size, static_cast<std::size_t>(align));
+}
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+  vir::test::detail::tracked_free(ptr);
+}
+void operator delete[](void *ptr, std::align_val_t) noexcept
+{
+  vir::test::detail::tracked_free(ptr);
+}
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+{
+  vir::test::detail::tracked_free(ptr);
+}
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept
+{
+  vir::test::detail::tracked_free(ptr);
+}
+void *operator new(std::size_t size, std::align_val_t align,
+                   const std::nothrow_t &) noexcept
+{
+  return vir::test::detail::tracked_new_nothrow(size, static_cast<std::size_t>(align));
+}
+void *operator new[](std::size_t size, std::align_val_t align,
+                     const std::nothrow_t &) noexcept
+{
+  return vir::test::detail::tracked_new_nothrow(size, static_cast<std::size_t>(align));
+}
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept
+{
+  vir::test::detail::tracked_free(ptr);
+}
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept
+{
+  vir::test::detail::tracked_free(ptr);
+}
+#endif
+
+//}}}1
+#endif  // VIR_TESTALLOC_H_
+// vim: foldmethod=marker
@@ -0,0 +1,57 @@
+/*{{{
+Copyright © 2026 Matthias Kretz <kretz@kde.org>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the names of contributing organizations nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+}}}*/
+
+
+// The vir.typelist module: `import vir.typelist;` provides the same entities as
+// `#include <vir/typelist.h>`, except for the VIR_CHOOSE_ONE_RANDOMLY macro.
+
+module;
+#include "typelist.h"
+
+export module vir.typelist;
+
+export namespace vir
+{
+using vir::Typelist;
+using vir::Template;
+using vir::Template1;
+using vir::ensure_typelist;
+using vir::ensure_typelist_t;
+using vir::list_size;
+using vir::concat;
+using vir::split;
+using vir::extract_type;
+using vir::outer_product;
+using vir::expand_one;
+using vir::expand_list;
+using vir::filter_predicate;
+using vir::filter_list;
+using vir::remove_duplicates;
+using vir::remove_duplicates_t;
+using vir::make_unique_typelist;
+using vir::compile_time_rand;
+}  // namespace vir
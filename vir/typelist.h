@@ -442,26 +442,93 @@ template <class T> using remove_duplicates_t = typename remove_duplicates<T>::ty
 template <class... Ts>
 using make_unique_typelist = typename remove_duplicates<Typelist<Ts...>>::type;
 
-// choose one randomly {{{1
+// choose randomly {{{1
+/**
+ * Compile-time pseudo-random choices from a Typelist.
+ *
+ * The seed is the value of the macro VIR_COMPILE_TIME_SEED (an unsigned integer, e.g. a
+ * date or a CI build number). If it is not defined, the time of compilation (__TIME__) is
+ * used, so that every build makes a different choice, but builds are not reproducible (or
+ * cacheable). In library mode (VIR_TEST_LIBRARY) the test TUs would see different times
+ * (an ODR violation), thus random choices require VIR_COMPILE_TIME_SEED there.
+ */
+#if defined VIR_COMPILE_TIME_SEED || !defined VIR_TEST_LIBRARY
+#define VIR_HAVE_COMPILE_TIME_SEED 1
+#endif
 class compile_time_rand {
+#if !defined VIR_COMPILE_TIME_SEED && defined VIR_HAVE_COMPILE_TIME_SEED
   static constexpr const char *const time = __TIME__;
-  static constexpr unsigned seed = (time[0] - '0') * 36000 + (time[1] - '0') * 3600 +
-                                   (time[3] - '0') * 600 + (time[4] - '0') * 60 +
-                                   (time[6] - '0') * 10 + (time[7] - '0');
+#endif
 
   template <int N> using _ = std::integral_constant<int, N>;
 
+  // Park-Miller: 0 is a fixed point of the generator
+  static constexpr unsigned next(unsigned long long s)
+  {
+    return static_cast<unsigned>(s * 48271u % 2147483647u);
+  }
+
+  // decorrelates neighbouring seeds (e.g. consecutive build numbers)
+  static constexpr unsigned mix(unsigned x, int rounds = 2)
+  {
+    return rounds == 0 ? x ^ (x >> 16) : mix((x ^ (x >> 16)) * 0x45d9f3bu, rounds - 1);
+  }
+
+  static constexpr unsigned start(unsigned s) { return mix(s) % 2147483646u + 1u; }
+
   static constexpr unsigned advance(_<0>, unsigned s) { return s; }
 
   template <int N> static constexpr unsigned advance(_<N>, unsigned s)
   {
-    return (advance(_<N - 1>(), s) * 48271u) % 2147483647u;
+    return next(advance(_<N - 1>(), s));
   }
 
+  template <class T, class List> struct prepend;
+  template <class T, class... Ts> struct prepend<T, Typelist<Ts...>> {
+    using type = Typelist<T, Ts...>;
+  };
+
+  // Selection sampling (Knuth's Algorithm S): takes each of the n remaining types with
+  // probability k/n, which yields exactly K types in list order.
+  template <std::size_t K, unsigned R, class... Ts> struct select;
+  template <unsigned R> struct select<0, R> {
+    using type = Typelist<>;
+  };
+  template <std::size_t K, unsigned R, class T, class... Ts> struct select<K, R, T, Ts...> {
+    static constexpr bool take = R % (sizeof...(Ts) + 1) < K;
+    using tail = typename select<K - take, next(R), Ts...>::type;
+    using type =
+        typename std::conditional<take, typename prepend<T, tail>::type, tail>::type;
+  };
+  template <std::size_t K, class List, unsigned R> struct select_from;
+  template <std::size_t K, class... Ts, unsigned R>
+  struct select_from<K, Typelist<Ts...>, R> {
+    static_assert(K <= sizeof...(Ts), "cannot choose more types than the list contains");
+    using type = typename select<K, R, Ts...>::type;
+  };
+
 public:
+  /// The seed of all choices in this translation unit (0 without
+  /// VIR_HAVE_COMPILE_TIME_SEED).
+  static constexpr unsigned seed()
+  {
+#ifdef VIR_COMPILE_TIME_SEED
+    return static_cast<unsigned>(VIR_COMPILE_TIME_SEED);
+#elif defined VIR_HAVE_COMPILE_TIME_SEED
+    return (time[0] - '0') * 36000 + (time[1] - '0') * 3600 + (time[3] - '0') * 600 +
+           (time[4] - '0') * 60 + (time[6] - '0') * 10 + (time[7] - '0');
+#else
+    return 0;
+#endif
+  }
+
   template <int N> static constexpr unsigned get(int add_to_seed)
   {
-    return advance(_<N + 1>(), seed + add_to_seed) / 2;
+#ifndef VIR_HAVE_COMPILE_TIME_SEED
+    static_assert(N != N, "random type choices in library mode (VIR_TEST_LIBRARY) "
+                          "require -DVIR_COMPILE_TIME_SEED=<unsigned>");
+#endif
+    return advance(_<N + 1>(), start(seed() + add_to_seed)) / 2;
   }
 
   template <class List, int N = List::size(),
@@ -500,11 +567,30 @@ public:
 #endif
             >
   using choose_one = typename List::template at<get<N>(K1 *K2) % List::size()>;
+
+  /**
+   * A Typelist of \p K distinct entries of \p List, in the order of \p List. The
+   * template arguments after \p List have the same meaning as for choose_one.
+   */
+  template <std::size_t K, class List, int N = List::size(),
+            unsigned K1 =
+#if defined __GNUC__ && __GNUC__ >= 5
+                __builtin_LINE(),
+#elif defined __COUNTER__
+                __COUNTER__,
+#else
+                0,
+#endif
+            unsigned K2 = 48271u>
+  using choose_k = typename select_from<K, List, get<N>(K1 *K2) + 1u>::type;
 };
 
 #define VIR_CHOOSE_ONE_RANDOMLY(...)                                                     \
   vir::Typelist<vir::compile_time_rand::choose_one<__VA_ARGS__, __COUNTER__, __LINE__>>
 
+#define VIR_CHOOSE_K_RANDOMLY(k_, ...)                                                   \
+  vir::compile_time_rand::choose_k<k_, __VA_ARGS__, __COUNTER__, __LINE__>
+
 // static_asserts {{{1
 #ifndef NDEBUG
 static_assert(
@@ -241,6 +241,46 @@ template <class T, class A> VIR_AUTO_OR_STRING typeToString_impl(Vc::simd_mask<T
 #endif  // Vc >= 1.4.0
 #endif  // VC_FWDDECL_H_
 
+// std::experimental::simd to string {{{1
+#ifdef __cpp_lib_experimental_parallel_simd
+#ifdef _GLIBCXX_EXPERIMENTAL_SIMD
+// the ABI tags of libstdc++
+VIR_CONSTEXPR_STRING_RET(7) typeToString_impl(std::experimental::simd_abi::_Scalar *)
+{
+  return "_Scalar";
+}
+template <int N>
+VIR_AUTO_OR_STRING typeToString_impl(std::experimental::simd_abi::_Fixed<N> *)
+{
+  return cs("fixed_size<") + number_to_string(std::integral_constant<int, N>()) + cs('>');
+}
+template <int N>
+VIR_AUTO_OR_STRING typeToString_impl(std::experimental::simd_abi::_VecBuiltin<N> *)
+{
+  return cs("_VecBuiltin<") + number_to_string(std::integral_constant<int, N>()) +
+         cs('>');
+}
+template <int N>
+VIR_AUTO_OR_STRING typeToString_impl(std::experimental::simd_abi::_VecBltnBtmsk<N> *)
+{
+  return cs("_VecBltnBtmsk<") + number_to_string(std::integral_constant<int, N>()) +
+         cs('>');
+}
+#endif  // _GLIBCXX_EXPERIMENTAL_SIMD
+template <class T, class A>
+VIR_AUTO_OR_STRING typeToString_impl(std::experimental::simd<T, A> *)
+{
+  return cs("simd<") + typeToStringRecurse<T>() + cs(", ") + typeToStringRecurse<A>() +
+         cs('>');
+}
+template <class T, class A>
+VIR_AUTO_OR_STRING typeToString_impl(std::experimental::simd_mask<T, A> *)
+{
+  return cs("simd_mask<") + typeToStringRecurse<T>() + cs(", ") + typeToStringRecurse<A>() +
+         cs('>');
+}
+#endif  // __cpp_lib_experimental_parallel_simd
+
 // generic fallback (typeid::name) {{{1
 template <typename T> inline std::string typeToString_impl(T *)
 {